@@ -5,44 +5,44 @@
 #ifndef ERRORHANDLING_ASSERT_H
 #define ERRORHANDLING_ASSERT_H
 
+// failing EXPECT/ENSURE format the checked value into the explanation, so this part depends on fmt
+#include "config.h"
 #include "types.h"
 #include "common_errors.h"
 #include "make_result.h"
+#include "formatting.h"
 
-#include <fmt/core.h>
+#if ERR_VERBOSITY >= ERR_VERBOSITY_FULL
 
-class AssertionException
-        : public std::logic_error
+template<class T>
+std::pmr::string format_expression(std::string_view expr, const T& result, std::string_view explanation)
 {
-public:
-    explicit AssertionException(error&& e)
-            : std::logic_error("Assertion make_failure")
-              , m_error(std::move(e))
-    {
-
-    }
-
-    [[nodiscard]] const error& get_error() const { return m_error; }
+    std::pmr::string formatted(detail::current_failure_resource());
+    fmt::format_to(std::back_inserter(formatted),
+                   "Expression: '{}'\n"
+                   "Result:      {}\n"
+                   "Explanation: {}",
+                   expr, result, explanation);
+    return formatted;
+}
 
-private:
-    error m_error;
-};
+#else
 
+// expression and explanation are stripped, the value is not formatted either to save the formatter per checked type
 template<class T>
-std::string format_expression(std::string_view expr, const T& result, std::string_view explanation)
+std::string_view format_expression(std::string_view, const T&, std::string_view)
 {
-    return fmt::format("Expression: '{}'\n"
-                       "Result:      {}\n"
-                       "Explanation: {}",
-                       expr, result, explanation);
+    return {};
 }
 
+#endif // ERR_VERBOSITY >= ERR_VERBOSITY_FULL
+
 #ifdef ASSERTIONS_TERMINATE
 
 template<class E>
-detail::failure<E> terminate_or_propagate(detail::failure<E>&& f)
+[[noreturn]] detail::failure<E> terminate_or_propagate(detail::failure<E>&& f)
 {
-    throw AssertionException(std::move(f.error));
+    detail::fail_assertion(std::move(f.error));
 }
 
 #else
@@ -56,45 +56,44 @@ detail::failure<E> terminate_or_propagate(detail::failure<E>&& f)
 #endif
 
 template<class V, class E, class L>
-auto fail_precondition(result<V, E, L>&& result,
-                       std::string_view expr,
-                       std::string_view explanation,
-                       source_location origin)
+ERR_COLD auto fail_precondition(result<V, E, L>&& result,
+                                const error_site& site,
+                                std::string_view explanation)
 {
 
     return terminate_or_propagate(
                 detail::make_failure(assertion_errors::precondition_error{},
-                                     format_expression(expr, result, explanation),
+                                     format_expression(site.expression, result, explanation),
                                      std::move(result).release_error(),
-                                     origin));
+                                     site));
 }
 
 template<class T>
-auto fail_precondition(T&& result, std::string_view expr, std::string_view explanation, source_location origin)
+ERR_COLD auto fail_precondition(T&& result, const error_site& site, std::string_view explanation)
 {
     return terminate_or_propagate(
                 detail::make_failure(assertion_errors::precondition_error{},
-                                     format_expression(expr, result, explanation),
-                                     origin));
+                                     format_expression(site.expression, result, explanation),
+                                     site));
 }
 
 template<class V, class E, class L>
-auto fail_postcondition(result<V, E, L>&& result, std::string_view expr, std::string_view explanation, source_location src_loc)
+ERR_COLD auto fail_postcondition(result<V, E, L>&& result, const error_site& site, std::string_view explanation)
 {
     return terminate_or_propagate(
                 detail::make_failure(assertion_errors::postcondition_error{},
-                                     format_expression(expr, result, explanation),
+                                     format_expression(site.expression, result, explanation),
                                      std::move(result).release_error(),
-                                     src_loc));
+                                     site));
 }
 
 template<class T>
-auto fail_postcondition(T&& result, std::string_view expr, std::string_view explanation, source_location src_loc)
+ERR_COLD auto fail_postcondition(T&& result, const error_site& site, std::string_view explanation)
 {
     return terminate_or_propagate(
                 detail::make_failure(assertion_errors::postcondition_error{},
-                                     format_expression(expr, result, explanation),
-                                     src_loc));
+                                     format_expression(site.expression, result, explanation),
+                                     site));
 }
 
 #endif //ERRORHANDLING_ASSERT_H
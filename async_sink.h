@@ -0,0 +1,304 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_ASYNC_SINK_H
+#define ERRORHANDLING_ASYNC_SINK_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "config.h"
+#include "formatting.h"
+#include "try.h"
+
+// moves formatting and writing of unhandled errors off the request thread. final_action hands the error chain
+// of a failed result over to a background thread through a bounded lock-free queue, the background thread
+// formats the errors and writes them in batches.
+//     error_sink::start({ .write = write_to_log_file });
+//     using logged_result = result<int, error, error_sink::final_action>;
+// errors allocated from a failure_memory_scope are written on the request thread, the resource of the scope
+// may be gone before the background thread frees them.
+namespace error_sink
+{
+    enum class overflow_policy : uint8_t
+    {
+        drop,   // the error is discarded
+        count,  // the error is discarded and counted, the background thread writes how many were lost
+        block   // the request thread waits until the background thread made room
+    };
+
+    struct options
+    {
+        std::size_t capacity = 4096; // rounded up to a power of two, fixed by the first start
+        std::size_t batch_size = 64; // errors per write
+        overflow_policy overflow = overflow_policy::count;
+        std::chrono::microseconds poll_interval = std::chrono::milliseconds(1); // while the queue is empty
+        void (*write)(std::string_view) = [](std::string_view text) { std::fwrite(text.data(), 1, text.size(), stderr); };
+    };
+
+    namespace detail
+    {
+        // bounded multi-producer single-consumer queue after Dmitry Vyukov's bounded MPMC queue.
+        // every cell carries a sequence number telling producers and the consumer whose turn it is,
+        // a push costs one CAS on the enqueue position, a pop no atomic read-modify-write at all.
+        template<class T>
+        class mpsc_queue
+        {
+        public:
+            explicit mpsc_queue(std::size_t capacity)
+                : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+                , m_cells(std::make_unique<cell[]>(m_mask + 1))
+            {
+                for(std::size_t i = 0; i <= m_mask; ++i)
+                {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            mpsc_queue(const mpsc_queue&) = delete;
+            mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+            // false if the queue is full, value is left untouched then
+            [[nodiscard]] bool try_push(T& value)
+            {
+                auto position = m_enqueue.load(std::memory_order_relaxed);
+                for(;;)
+                {
+                    auto& c = m_cells[position & m_mask];
+                    const auto sequence = c.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                    if(diff == 0)
+                    {
+                        if(m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            c.value = std::move(value);
+                            c.sequence.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        position = m_enqueue.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // only called by the consumer
+            [[nodiscard]] bool try_pop(T& value)
+            {
+                auto& c = m_cells[m_dequeue & m_mask];
+                if(c.sequence.load(std::memory_order_acquire) != m_dequeue + 1)
+                {
+                    return false;
+                }
+
+                value = std::move(c.value);
+                c.sequence.store(m_dequeue + m_mask + 1, std::memory_order_release);
+                ++m_dequeue;
+                return true;
+            }
+
+            [[nodiscard]] std::size_t capacity() const { return m_mask + 1; }
+
+        private:
+            struct cell
+            {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            const std::size_t m_mask;
+            std::unique_ptr<cell[]> m_cells;
+            alignas(64) std::atomic<std::size_t> m_enqueue { 0 };
+            alignas(64) std::size_t m_dequeue = 0;
+        };
+
+        struct sink
+        {
+            options settings;
+            std::unique_ptr<mpsc_queue<failure_ptr<error>>> queue;
+            std::atomic<bool> running { false };
+            std::atomic<uint32_t> producers { 0 }; // in submit, the consumer does not exit before they are done
+            std::atomic<uint64_t> dropped { 0 }; // not yet reported
+            std::atomic<uint64_t> dropped_total { 0 };
+            std::thread consumer;
+        };
+
+        // never destroyed, producers may still see it while the process exits
+        inline sink& get_sink()
+        {
+            static auto instance = new sink;
+            return *instance;
+        }
+
+        inline void consume(sink& s)
+        {
+            fmt::memory_buffer buffer;
+            failure_ptr<error> e;
+
+            for(;;)
+            {
+                // producers that saw the sink running push before they leave, a later one sees it stopped
+                const auto stopping = !s.running.load() && s.producers.load() == 0;
+
+                std::size_t count = 0;
+                for(; count < s.settings.batch_size && s.queue->try_pop(e); ++count)
+                {
+                    fmt::format_to(std::back_inserter(buffer), "{}\n", *e);
+                    e.reset();
+                }
+
+                if(const auto dropped = s.dropped.exchange(0, std::memory_order_relaxed))
+                {
+                    fmt::format_to(std::back_inserter(buffer), "dropped {} errors, the error queue was full\n", dropped);
+                }
+
+                if(buffer.size() != 0)
+                {
+                    s.settings.write(std::string_view(buffer.data(), buffer.size()));
+                    buffer.clear();
+                }
+
+                // the queue was drained after stop was requested
+                if(count == 0 && stopping)
+                {
+                    return;
+                }
+
+                if(count == 0)
+                {
+                    std::this_thread::sleep_for(s.settings.poll_interval);
+                }
+            }
+        }
+
+        ERR_COLD inline void write_now(const error& e)
+        {
+            get_sink().settings.write(fmt::format("{}\n", e));
+        }
+
+        struct producer_guard
+        {
+            explicit producer_guard(sink& s) : s(s) { s.producers.fetch_add(1); }
+            ~producer_guard() { s.producers.fetch_sub(1); }
+
+            sink& s;
+        };
+
+        ERR_COLD inline void submit(failure_ptr<error>&& e)
+        {
+            auto& s = get_sink();
+            if(::detail::failure_resource_slot() != nullptr)
+            {
+                write_now(*e);
+                return;
+            }
+
+            // registered before running is checked, so stop() can not slip in between the check and the push
+            producer_guard guard(s);
+            if(!s.running.load())
+            {
+                write_now(*e);
+                return;
+            }
+
+            while(!s.queue->try_push(e))
+            {
+                switch(s.settings.overflow)
+                {
+                    case overflow_policy::drop:
+                        return;
+                    case overflow_policy::count:
+                        s.dropped.fetch_add(1, std::memory_order_relaxed);
+                        s.dropped_total.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    case overflow_policy::block:
+                        if(!s.running.load(std::memory_order_relaxed))
+                        {
+                            write_now(*e);
+                            return;
+                        }
+                        std::this_thread::yield();
+                        break;
+                }
+            }
+        }
+    }
+
+    // starts the background thread, the sink must not be running
+    inline void start(const options& o = {})
+    {
+        auto& s = detail::get_sink();
+        ERR_EXPECTS(!s.running.load());
+
+        s.settings = o;
+        if(!s.queue)
+        {
+            s.queue = std::make_unique<detail::mpsc_queue<failure_ptr<error>>>(o.capacity);
+        }
+
+        s.running.store(true, std::memory_order_release);
+        s.consumer = std::thread([&s]() { detail::consume(s); });
+    }
+
+    // writes the queued errors and joins the background thread, failures dropped afterwards are written synchronously
+    inline void stop()
+    {
+        auto& s = detail::get_sink();
+        if(s.running.exchange(false, std::memory_order_acq_rel))
+        {
+            s.consumer.join();
+        }
+    }
+
+    // errors lost by overflow_policy::count since the process started
+    [[nodiscard]] inline uint64_t dropped_errors()
+    {
+        return detail::get_sink().dropped_total.load(std::memory_order_relaxed);
+    }
+
+    // final action handing the error of failed results to the sink. takes the error out of the result,
+    // it is invoked from the destructor where the error is not needed anymore
+    struct final_action
+    {
+        template<class R>
+        void operator()(R& r) const noexcept
+        {
+            if(ERR_LIKELY(!r.has_failed()))
+            {
+                return;
+            }
+
+            using error_type = std::remove_cvref_t<decltype(r.unchecked_error())>;
+            if constexpr(::detail::is_inline_error_v<error_type>)
+            {
+                detail::submit(make_failure_ptr<error>(::detail::escalate(r.unchecked_error(), ::detail::unknown_site)));
+            }
+            else if constexpr(std::is_const_v<R>)
+            {
+                detail::write_now(r.unchecked_error());
+            }
+            else
+            {
+                detail::submit(std::move(r).release_error());
+            }
+        }
+    };
+}
+
+#endif //ERRORHANDLING_ASYNC_SINK_H
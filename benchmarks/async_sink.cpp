@@ -0,0 +1,94 @@
+//
+// Created by flori on 19.10.2026.
+//
+// request thread latency while every 10th request drops a failed result:
+// formatting and writing in the final action vs. handing the error to the async sink.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "../result.h"
+#include "../macros.h"
+#include "../async_sink.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, connection_reset, "Connection reset");
+    }
+
+    std::FILE* out = nullptr;
+
+    void write_out(std::string_view text) { std::fwrite(text.data(), 1, text.size(), out); }
+
+    // what main.cpp's LogErrorOnDestruction does
+    struct write_synchronously
+    {
+        template<class R>
+        void operator()(const R& r) const noexcept
+        {
+            if(r.has_failed())
+            {
+                write_out(fmt::format("{}\n", r.get_error()));
+            }
+        }
+    };
+
+    template<class FinalAction>
+    [[gnu::noinline]] result<int, error, FinalAction> call_backend(int request)
+    {
+        if(request % 10 == 0)
+        {
+            return err(errors::connection_reset{}, "peer went away");
+        }
+        return ok(request);
+    }
+
+    template<class FinalAction>
+    [[gnu::noinline]] result<int, error, FinalAction> handle_request(int request)
+    {
+        TRY_ASSIGN(const auto value, call_backend<FinalAction>(request));
+        return ok(value * 2);
+    }
+
+    template<class FinalAction>
+    void report(std::string_view name)
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr int requests = 200'000;
+        std::vector<double> latencies;
+        latencies.reserve(requests);
+
+        for(int i = 0; i < requests; ++i)
+        {
+            const auto start = clock::now();
+            bench::do_not_optimize(handle_request<FinalAction>(i).has_failed());
+            latencies.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        const auto at = [&](double q) { return latencies[static_cast<std::size_t>(q * (latencies.size() - 1))]; };
+        fmt::print("{:<32} p50 {:>8.0f} ns   p99 {:>8.0f} ns   p99.9 {:>8.0f} ns\n", name, at(0.5), at(0.99), at(0.999));
+    }
+}
+
+int main()
+{
+    out = std::fopen("/dev/null", "w");
+
+    report<write_synchronously>("format and write in the action");
+
+    error_sink::start({ .capacity = 1 << 16, .write = write_out });
+    report<error_sink::final_action>("async sink");
+    error_sink::stop();
+
+    report<::detail::default_final_action>("no logging");
+    fmt::print("{} errors dropped by the sink\n", error_sink::dropped_errors());
+}
@@ -0,0 +1,56 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_BENCHMARK_H
+#define ERRORHANDLING_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+#include <fmt/core.h>
+
+namespace bench
+{
+    template<class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // best of several runs, reported in nanoseconds per operation
+    template<class F>
+    double measure(std::string_view name, std::size_t iterations, F&& f, int runs = 7)
+    {
+        using clock = std::chrono::steady_clock;
+
+        for(std::size_t i = 0; i < iterations / 10 + 1; ++i)
+        {
+            f();
+        }
+
+        double best = 1e300;
+        for(int run = 0; run < runs; ++run)
+        {
+            const auto start = clock::now();
+            for(std::size_t i = 0; i < iterations; ++i)
+            {
+                f();
+            }
+            const auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            best = std::min(best, elapsed / static_cast<double>(iterations));
+        }
+
+        fmt::print("{:<48} {:>10.2f} ns/op\n", name, best);
+        return best;
+    }
+}
+
+#endif //ERRORHANDLING_BENCHMARK_H
@@ -0,0 +1,25 @@
+#!/usr/bin/env sh
+# Reports the code size per TRY site of the try_sites benchmark binaries.
+# usage: code_size_report.sh <binary>...
+#
+# hot:  size of the hot_path<N> functions themselves (what ends up in the instruction cache)
+# cold: size of their .cold clones and of the outlined failure helpers
+
+SITES_PER_FUNCTION=32
+
+for binary in "$@"; do
+    nm -S -C --size-sort "$binary" | awk -v binary="$(basename "$binary")" -v sites="$SITES_PER_FUNCTION" '
+        function size(hex,    i, n) {
+            n = 0
+            for(i = 1; i <= length(hex); i++) { n = n * 16 + index("0123456789abcdef", tolower(substr(hex, i, 1))) - 1 }
+            return n
+        }
+        /hot_path<[0-9]+>\(int\) \[clone \.cold\]/ { cold += size($2); next }
+        /hot_path<[0-9]+>\(int\)$/                  { hot += size($2); functions++; next }
+        /propagate_failure|make_failure/             { cold += size($2); next }
+        END {
+            if(functions == 0) { print binary ": no hot_path symbols found"; exit 1 }
+            printf "%-32s hot %7d bytes (%6.1f bytes/TRY site), cold %7d bytes\n",
+                   binary, hot, hot / (functions * sites), cold
+        }'
+done
@@ -0,0 +1,84 @@
+#!/usr/bin/env sh
+# Compile time of a synthetic project: many translation units, each with a few functions using TRY.
+# usage: compile_time.sh [translation units] [variant]...
+#
+# variants:
+#   umbrella  every TU includes macros.h and formatting.h (everything, including fmt)
+#   core      every TU includes try.h only (result, errors and TRY, no fmt)
+#
+# environment: CXX, CXXFLAGS (e.g. include paths of fmt and gsl)
+
+set -e
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+UNITS=${1:-50}
+shift 2>/dev/null || true
+VARIANTS=${*:-umbrella core}
+CXX=${CXX:-c++}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+generate() # <directory> <prologue>
+{
+    mkdir -p "$1"
+    i=0
+    while [ "$i" -lt "$UNITS" ]; do
+        cat > "$1/unit_$i.cpp" <<SOURCE
+$2
+
+namespace unit_$i
+{
+    DEFINE_ERROR_CATEGORY(1000 + $i, category);
+    DEFINE_ERROR_CODE(1, category, negative_error, "Negative");
+
+    result<int> parse(int x)
+    {
+        if(x < 0)
+        {
+            return err(negative_error{}, "negative input");
+        }
+        return ok(x);
+    }
+
+    result<int> twice(int x)
+    {
+        TRY_ASSIGN(const auto y, parse(x));
+        return ok(2 * y);
+    }
+
+    result<> check(int x)
+    {
+        TRY(twice(x));
+        return ok();
+    }
+}
+
+result<> entry_$i(int x) { return unit_$i::check(x); }
+SOURCE
+        i=$((i + 1))
+    done
+}
+
+now() { date +%s.%N; }
+
+for variant in $VARIANTS; do
+    dir="$WORK/$variant"
+    # -iquote: assert.h, error.h and memory.h of the library must not shadow the system headers
+    flags="-std=c++20 -iquote $SOURCE_DIR $CXXFLAGS"
+    start=$(now)
+
+    case "$variant" in
+        umbrella) generate "$dir" '#include "macros.h"
+#include "formatting.h"' ;;
+        core)     generate "$dir" '#include "try.h"' ;;
+        *) echo "unknown variant $variant"; exit 1 ;;
+    esac
+
+    for unit in "$dir"/unit_*.cpp; do
+        (cd "$dir" && $CXX $flags -c "$unit" -o "$unit.o")
+    done
+
+    end=$(now)
+    awk -v variant="$variant" -v units="$UNITS" -v start="$start" -v end="$end" \
+        'BEGIN { printf "%-10s %4d TUs %8.2f s (%6.1f ms/TU)\n", variant, units, end - start, (end - start) * 1000 / units }'
+done
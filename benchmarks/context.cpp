@@ -0,0 +1,117 @@
+//
+// Created by flori on 19.10.2026.
+//
+// request context on errors: lazy breadcrumbs vs. formatting the context into every level eagerly.
+
+#include <string>
+
+#include "../result.h"
+#include "../macros.h"
+#include "../formatting.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, out_of_range, "Offset out of range");
+    }
+
+    [[gnu::noinline]] result<int> check_offset(int offset)
+    {
+        if(offset > 100)
+        {
+            return err(errors::out_of_range{}, "offset past the end");
+        }
+        return ok(offset);
+    }
+
+    // three levels, each with its own context
+    [[gnu::noinline]] result<int> read_block(int offset)
+    {
+        error_context::scope ctx([&] { return fmt::format("offset {}", offset); });
+        TRY_ASSIGN(const auto block, check_offset(offset));
+        return ok(block);
+    }
+
+    [[gnu::noinline]] result<int> load_shard(int shard, int offset)
+    {
+        error_context::scope ctx([&] { return fmt::format("shard {}", shard); });
+        TRY_ASSIGN(const auto block, read_block(offset));
+        return ok(block);
+    }
+
+    [[gnu::noinline]] result<int> handle_request(int id, int offset)
+    {
+        error_context::scope ctx([&] { return fmt::format("request {}", id); });
+        TRY_ASSIGN(const auto block, load_shard(id % 16, offset));
+        return ok(block);
+    }
+
+    // the same without context
+    [[gnu::noinline]] result<int> read_block_plain(int offset)
+    {
+        TRY_ASSIGN(const auto block, check_offset(offset));
+        return ok(block);
+    }
+
+    [[gnu::noinline]] result<int> load_shard_plain(int, int offset)
+    {
+        TRY_ASSIGN(const auto block, read_block_plain(offset));
+        return ok(block);
+    }
+
+    [[gnu::noinline]] result<int> handle_request_plain(int id, int offset)
+    {
+        TRY_ASSIGN(const auto block, load_shard_plain(id % 16, offset));
+        return ok(block);
+    }
+
+    // what callers did before: the context is formatted at every level, whether it is needed or not
+    [[gnu::noinline]] result<int> read_block_eager(int offset)
+    {
+        const auto context = fmt::format("offset {}", offset);
+        auto r = check_offset(offset);
+        if(r.has_failed())
+        {
+            return err(errors::out_of_range{}, context, std::move(r));
+        }
+        return r;
+    }
+
+    [[gnu::noinline]] result<int> load_shard_eager(int shard, int offset)
+    {
+        const auto context = fmt::format("shard {}", shard);
+        auto r = read_block_eager(offset);
+        if(r.has_failed())
+        {
+            return err(errors::out_of_range{}, context, std::move(r));
+        }
+        return r;
+    }
+
+    [[gnu::noinline]] result<int> handle_request_eager(int id, int offset)
+    {
+        const auto context = fmt::format("request {}", id);
+        auto r = load_shard_eager(id % 16, offset);
+        if(r.has_failed())
+        {
+            return err(errors::out_of_range{}, context, std::move(r));
+        }
+        return r;
+    }
+}
+
+int main()
+{
+    int id = 0;
+    bench::measure("success, no context", 10'000'000, [&]() { bench::do_not_optimize(handle_request_plain(++id, 10).has_failed()); });
+    bench::measure("success, lazy breadcrumbs", 10'000'000, [&]() { bench::do_not_optimize(handle_request(++id, 10).has_failed()); });
+    bench::measure("success, eagerly formatted", 10'000'000, [&]() { bench::do_not_optimize(handle_request_eager(++id, 10).has_failed()); });
+
+    bench::measure("failure, no context", 1'000'000, [&]() { bench::do_not_optimize(handle_request_plain(++id, 200).has_failed()); });
+    bench::measure("failure, lazy breadcrumbs", 1'000'000, [&]() { bench::do_not_optimize(handle_request(++id, 200).has_failed()); });
+    bench::measure("failure, eagerly formatted", 1'000'000, [&]() { bench::do_not_optimize(handle_request_eager(++id, 200).has_failed()); });
+}
@@ -0,0 +1,107 @@
+//
+// Created by flori on 19.10.2026.
+//
+// summing the values of results that were checked with is_ok() in an earlier pass:
+// get_value (checked per ERR_CONTRACT_LEVEL) vs unchecked_value vs a plain int array.
+// built once per contract level, see CMakeLists.txt.
+
+#include <cstdint>
+#include <vector>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, odd_error, "Odd");
+    }
+
+    using small_result = result<int, error_code>;
+
+    std::vector<small_result> make_results(std::size_t count)
+    {
+        std::vector<small_result> results;
+        results.reserve(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            if(i % 16 == 15)
+            {
+                results.emplace_back(err(errors::odd_error{}));
+            }
+            else
+            {
+                results.emplace_back(ok(static_cast<int>(i)));
+            }
+        }
+        return results;
+    }
+
+    // the values are read in a second pass over the results that passed the check,
+    // the compiler can not prove is_ok() there and keeps every check of get_value
+    [[gnu::noinline]] std::vector<std::uint32_t> ok_indices(const std::vector<small_result>& results)
+    {
+        std::vector<std::uint32_t> indices;
+        for(std::uint32_t i = 0; i < results.size(); ++i)
+        {
+            if(results[i].is_ok())
+            {
+                indices.push_back(i);
+            }
+        }
+        return indices;
+    }
+
+    [[gnu::noinline]] std::int64_t sum_checked(const std::vector<small_result>& results, const std::vector<std::uint32_t>& indices)
+    {
+        std::int64_t sum = 0;
+        for(const auto i : indices)
+        {
+            sum += results[i].get_value();
+        }
+        return sum;
+    }
+
+    [[gnu::noinline]] std::int64_t sum_unchecked(const std::vector<small_result>& results, const std::vector<std::uint32_t>& indices)
+    {
+        std::int64_t sum = 0;
+        for(const auto i : indices)
+        {
+            sum += results[i].unchecked_value();
+        }
+        return sum;
+    }
+
+    [[gnu::noinline]] std::int64_t sum_plain(const std::vector<int>& values, const std::vector<std::uint32_t>& indices)
+    {
+        std::int64_t sum = 0;
+        for(const auto i : indices)
+        {
+            sum += values[i];
+        }
+        return sum;
+    }
+}
+
+int main()
+{
+    constexpr std::size_t count = 4096;
+    const auto results = make_results(count);
+
+    const auto indices = ok_indices(results);
+
+    std::vector<int> values(count);
+    for(const auto i : indices)
+    {
+        values[i] = results[i].get_value();
+    }
+
+    fmt::print("ERR_CONTRACT_LEVEL {}, {} results\n", ERR_CONTRACT_LEVEL, count);
+    bench::measure("get_value", 10'000, [&]() { bench::do_not_optimize(sum_checked(results, indices)); });
+    bench::measure("unchecked_value", 10'000, [&]() { bench::do_not_optimize(sum_unchecked(results, indices)); });
+    bench::measure("plain int array", 10'000, [&]() { bench::do_not_optimize(sum_plain(values, indices)); });
+}
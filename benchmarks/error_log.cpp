@@ -0,0 +1,64 @@
+//
+// Created by flori on 19.10.2026.
+//
+// the same failure dropped over and over: formatting every one vs. the deduplicating final action.
+
+#include <cstdio>
+#include <string_view>
+
+#include "../result.h"
+#include "../macros.h"
+#include "../error_log.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, connection_reset, "Connection reset");
+    }
+
+    std::size_t written = 0;
+
+    void count_bytes(std::string_view text) { written += text.size(); }
+
+    // what main.cpp's LogErrorOnDestruction does, minus the I/O
+    struct format_every_failure
+    {
+        template<class R>
+        void operator()(const R& r) const noexcept
+        {
+            if(r.has_failed())
+            {
+                count_bytes(fmt::format("{}\n", r.get_error()));
+            }
+        }
+    };
+
+    template<class FinalAction>
+    [[gnu::noinline]] result<int, error, FinalAction> call_backend()
+    {
+        return err(errors::connection_reset{}, "peer went away");
+    }
+
+    template<class FinalAction>
+    [[gnu::noinline]] result<int, error, FinalAction> handle_request()
+    {
+        TRY_ASSIGN(const auto value, call_backend<FinalAction>());
+        return ok(value);
+    }
+}
+
+int main()
+{
+    error_log::configure({ .first_n = 10, .interval = std::chrono::seconds(10), .write = count_bytes });
+
+    bench::measure("format every failure", 1'000'000, []() { std::ignore = handle_request<format_every_failure>(); });
+    bench::measure("deduplicating final action", 1'000'000, []() { std::ignore = handle_request<error_log::final_action>(); });
+    bench::measure("no logging", 1'000'000, []() { std::ignore = handle_request<::detail::default_final_action>(); });
+
+    error_log::flush();
+    fmt::print("{} bytes written\n", written);
+}
@@ -0,0 +1,57 @@
+//
+// Created by flori on 19.10.2026.
+//
+// a TRY chain that succeeds, one that fails with data attached, reading that data back and a checked EXPECT.
+// built with the default flags and with -fno-exceptions -fno-rtti, see CMakeLists.txt (target exceptions_size).
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, out_of_range, "Out of range");
+    }
+
+    volatile int limit = 1000;
+
+    [[gnu::noinline]] result<int> parse(int value)
+    {
+        if(value > limit)
+        {
+            return err(errors::out_of_range{}, "above the limit", value);
+        }
+        return ok(value);
+    }
+
+    [[gnu::noinline]] result<int> checked(int value)
+    {
+        EXPECT(value >= 0, "negative values are not parsed");
+        TRY_ASSIGN(const auto parsed, parse(value));
+        return ok(parsed + 1);
+    }
+
+    [[gnu::noinline]] result<int> twice(int value)
+    {
+        TRY_ASSIGN(const auto first, checked(value));
+        TRY_ASSIGN(const auto second, checked(first));
+        return ok(second);
+    }
+}
+
+int main()
+{
+    fmt::print("exceptions {}\n", ERR_EXCEPTIONS ? "on" : "off");
+
+    int value = 0;
+    bench::measure("TRY chain, ok", 10'000'000, [&]() { bench::do_not_optimize(twice(++value & 511).get_value()); });
+    bench::measure("TRY chain, failing", 1'000'000, [&]() { bench::do_not_optimize(twice(2000).has_failed()); });
+
+    auto failed = parse(2000);
+    const auto& e = failed.get_error();
+    bench::measure("get_data of the failure", 10'000'000, [&]() { bench::do_not_optimize(e.get_data<int>()); });
+}
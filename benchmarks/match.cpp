@@ -0,0 +1,97 @@
+//
+// Created by flori on 19.10.2026.
+//
+// classifying errors: switch on the sparse 64 bit ids vs. match with its per-category dispatch table.
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../result.h"
+#include "../macros.h"
+#include "../match.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, io_category);
+        DEFINE_ERROR_CODE(1, io_category, not_found, "Not found");
+        DEFINE_ERROR_CODE(2, io_category, denied, "Denied");
+        DEFINE_ERROR_CODE(3, io_category, busy, "Busy");
+        DEFINE_ERROR_CODE(4, io_category, full, "Full");
+
+        DEFINE_ERROR_CATEGORY(200, net_category);
+        DEFINE_ERROR_CODE(1, net_category, reset, "Reset");
+        DEFINE_ERROR_CODE(2, net_category, refused, "Refused");
+        DEFINE_ERROR_CODE(3, net_category, timeout, "Timeout");
+        DEFINE_ERROR_CODE(4, net_category, unreachable, "Unreachable");
+    }
+
+    using namespace errors;
+
+    [[gnu::noinline]] int classify_switch(const error_code& code)
+    {
+        switch(code)
+        {
+            case not_found::id:     return 1;
+            case denied::id:        return 2;
+            case busy::id:          return 3;
+            case full::id:          return 4;
+            case reset::id:         return 5;
+            case refused::id:       return 6;
+            case timeout::id:       return 7;
+            case unreachable::id:   return 8;
+            default:                return 0;
+        }
+    }
+
+    [[gnu::noinline]] int classify_match(const error_code& code)
+    {
+        return match(code,
+                     on<not_found>([]() { return 1; }),
+                     on<denied>([]() { return 2; }),
+                     on<busy>([]() { return 3; }),
+                     on<full>([]() { return 4; }),
+                     on<reset>([]() { return 5; }),
+                     on<refused>([]() { return 6; }),
+                     on<timeout>([]() { return 7; }),
+                     on<unreachable>([]() { return 8; }),
+                     otherwise([]() { return 0; }));
+    }
+}
+
+int main()
+{
+    const std::array<error_code, 8> codes { not_found{}, denied{}, busy{}, full{}, reset{}, refused{}, timeout{}, unreachable{} };
+
+    std::minstd_rand engine { 42 };
+    std::vector<error_code> sequence;
+    for(int i = 0; i < 4096; ++i)
+    {
+        sequence.push_back(codes[engine() % codes.size()]);
+    }
+
+    bench::measure("switch on the global id (4096 codes)", 1'000, [&]()
+    {
+        int sum = 0;
+        for(const auto& code : sequence)
+        {
+            sum += classify_switch(code);
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    bench::measure("match (4096 codes)", 1'000, [&]()
+    {
+        int sum = 0;
+        for(const auto& code : sequence)
+        {
+            sum += classify_match(code);
+        }
+        bench::do_not_optimize(sum);
+    });
+}
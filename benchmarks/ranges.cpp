@@ -0,0 +1,89 @@
+//
+// Created by flori on 19.10.2026.
+//
+// parse, validate and scale 1000 numbers: a lazy pipeline collected once vs. a loop per stage with
+// an intermediate vector between the stages, all succeeding and failing at the last element.
+
+#include <vector>
+
+#include "../result.h"
+#include "../macros.h"
+#include "../ranges.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, out_of_range, "Out of range");
+    }
+
+    [[gnu::noinline]] result<int> parse(int raw)
+    {
+        if(raw < 0)
+        {
+            return err(errors::out_of_range{}, "negative");
+        }
+        return ok(raw);
+    }
+
+    [[gnu::noinline]] result<int> validate(int value)
+    {
+        if(value > 1'000'000)
+        {
+            return err(errors::out_of_range{}, "too large");
+        }
+        return ok(value);
+    }
+
+    result<std::vector<int>> pipeline(const std::vector<int>& input)
+    {
+        return input | std::views::transform(parse)
+                     | result_views::and_then(validate)
+                     | result_views::map_value([](int value) { return value * 2; })
+                     | collect_results();
+    }
+
+    result<std::vector<int>> stages(const std::vector<int>& input)
+    {
+        std::vector<int> parsed;
+        for(auto raw : input)
+        {
+            TRY_ASSIGN(auto value, parse(raw));
+            parsed.push_back(value);
+        }
+
+        std::vector<int> validated;
+        for(auto value : parsed)
+        {
+            TRY_ASSIGN(auto valid, validate(value));
+            validated.push_back(valid);
+        }
+
+        std::vector<int> scaled;
+        for(auto value : validated)
+        {
+            scaled.push_back(value * 2);
+        }
+        return ok(std::move(scaled));
+    }
+}
+
+int main()
+{
+    std::vector<int> input(1000);
+    for(int i = 0; i < 1000; ++i)
+    {
+        input[i] = i;
+    }
+    auto failing = input;
+    failing.back() = 2'000'000; // fails validation, after the first stage
+
+    // per batch of 1000 elements
+    bench::measure("stage loops, all ok", 100'000, [&]() { bench::do_not_optimize(stages(input).is_ok()); });
+    bench::measure("pipeline, all ok", 100'000, [&]() { bench::do_not_optimize(pipeline(input).is_ok()); });
+    bench::measure("stage loops, last fails", 100'000, [&]() { bench::do_not_optimize(stages(failing).is_ok()); });
+    bench::measure("pipeline, last fails", 100'000, [&]() { bench::do_not_optimize(pipeline(failing).is_ok()); });
+}
@@ -0,0 +1,85 @@
+//
+// Created by flori on 18.10.2026.
+//
+// Multi-threaded throughput of result_cache with a mix of cached successes and failures.
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../result_cache.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, backend_error, "Backend unavailable");
+    }
+
+    // every 10th key fails
+    result<std::uint64_t> load(const std::uint64_t& key)
+    {
+        if(key % 10 == 0)
+        {
+            return err(errors::backend_error{}, "backend unavailable");
+        }
+
+        return ok(key * key);
+    }
+
+    double run(result_cache<std::uint64_t, std::uint64_t>& cache, unsigned threads, std::uint64_t keys, std::size_t operations)
+    {
+        std::atomic<bool> start = false;
+        std::vector<std::thread> workers;
+
+        for(unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+            {
+                std::mt19937_64 random(t);
+                std::uniform_int_distribution<std::uint64_t> distribution(0, keys - 1);
+
+                while(!start.load(std::memory_order_acquire)) {}
+
+                std::uint64_t sum = 0;
+                for(std::size_t i = 0; i < operations; ++i)
+                {
+                    const auto cached = cache.get_or_load(distribution(random), load);
+                    sum += cached->is_ok() ? cached->get_value() : 1;
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        for(auto& worker : workers)
+        {
+            worker.join();
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        return static_cast<double>(threads * operations) / elapsed;
+    }
+}
+
+int main()
+{
+    constexpr std::size_t operations = 1'000'000;
+    const auto max_threads = std::max(8u, std::thread::hardware_concurrency());
+
+    for(const std::uint64_t keys : { 1'000ull, 100'000ull })
+    {
+        for(unsigned threads = 1; threads <= max_threads; threads *= 2)
+        {
+            result_cache<std::uint64_t, std::uint64_t> cache({ .capacity = 10'000, .shards = 64 });
+            const auto throughput = run(cache, threads, keys, operations);
+            fmt::print("{:>7} keys, capacity 10000, {:>3} threads: {:>8.2f} Mops/s\n", keys, threads, throughput / 1e6);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Created by flori on 19.10.2026.
+//
+// a cache miss that fails every lookup: a fresh error per failure vs. a static error, on one and on four threads.
+
+#include <thread>
+#include <vector>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, cache_miss, "Cache miss");
+    }
+
+    [[gnu::noinline]] result<int> lookup_fresh(int key)
+    {
+        if(key >= 0)
+        {
+            return err(errors::cache_miss{}, "not cached");
+        }
+        return ok(key);
+    }
+
+    [[gnu::noinline]] result<int> lookup_static(int key)
+    {
+        if(key >= 0)
+        {
+            return static_err(errors::cache_miss{}, "not cached");
+        }
+        return ok(key);
+    }
+
+    template<class F>
+    void on_threads(int threads, int iterations, F f)
+    {
+        std::vector<std::thread> workers;
+        for(int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]()
+            {
+                for(int i = 0; i < iterations; ++i)
+                {
+                    bench::do_not_optimize(f(i).has_failed());
+                }
+            });
+        }
+        for(auto& w : workers)
+        {
+            w.join();
+        }
+    }
+}
+
+int main()
+{
+    int key = 0;
+    bench::measure("err, 1 thread", 10'000'000, [&]() { bench::do_not_optimize(lookup_fresh(++key).has_failed()); });
+    bench::measure("static_err, 1 thread", 10'000'000, [&]() { bench::do_not_optimize(lookup_static(++key).has_failed()); });
+
+    // per batch of 4 x 100k lookups
+    bench::measure("err, 4 threads x 100k lookups", 10, []() { on_threads(4, 100'000, lookup_fresh); }, 5);
+    bench::measure("static_err, 4 threads x 100k lookups", 10, []() { on_threads(4, 100'000, lookup_static); }, 5);
+}
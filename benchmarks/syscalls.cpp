@@ -0,0 +1,97 @@
+//
+// Created by flori on 19.10.2026.
+//
+// draining a non-blocking pipe until EAGAIN: raw read() and errno vs. sys::read and errno_code.
+// every iteration writes one chunk, reads it and then hits EAGAIN once.
+
+#include <cerrno>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "../system_errors.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    constexpr std::size_t chunk = 64;
+
+    struct pipe_fds
+    {
+        int read_end;
+        int write_end;
+    };
+
+    pipe_fds open_pipe()
+    {
+        const auto fds = sys::pipe().get_value();
+        std::ignore = sys::set_nonblocking(fds[0]);
+        return { fds[0], fds[1] };
+    }
+
+    [[gnu::noinline]] std::size_t drain_raw(const pipe_fds& p)
+    {
+        char buffer[chunk];
+        std::size_t total = 0;
+        for(;;)
+        {
+            const auto count = ::read(p.read_end, buffer, sizeof(buffer));
+            if(count == -1)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                if(errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    return total;
+                }
+                std::perror("read");
+                return total;
+            }
+            total += static_cast<std::size_t>(count);
+        }
+    }
+
+    [[gnu::noinline]] std::size_t drain_result(const pipe_fds& p)
+    {
+        char buffer[chunk];
+        std::size_t total = 0;
+        for(;;)
+        {
+            const auto r = sys::restart_on_eintr([&]() { return sys::read(p.read_end, buffer, sizeof(buffer)); });
+            if(r.has_failed())
+            {
+                if(!r.get_error().would_block())
+                {
+                    fmt::print("read: {}\n", system_errors::code(r.get_error().value).get_description());
+                }
+                return total;
+            }
+            total += r.get_value();
+        }
+    }
+
+    template<class Drain>
+    void run(std::string_view name, Drain drain)
+    {
+        const auto p = open_pipe();
+        const char data[chunk] = {};
+
+        bench::measure(name, 1'000'000, [&]()
+        {
+            std::ignore = ::write(p.write_end, data, sizeof(data));
+            bench::do_not_optimize(drain(p));
+        });
+
+        ::close(p.read_end);
+        ::close(p.write_end);
+    }
+}
+
+int main()
+{
+    run("raw read and errno", drain_raw);
+    run("sys::read", drain_result);
+}
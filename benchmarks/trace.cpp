@@ -0,0 +1,74 @@
+//
+// Created by flori on 18.10.2026.
+//
+// Cost of the trace points on the success path and on a short failure path.
+// Built twice: without tracing and with ERR_TRACING, where it runs once disabled and once enabled.
+
+#include <cstdint>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+#ifndef TRACE_VARIANT
+#define TRACE_VARIANT "compiled out"
+#endif
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, odd_error, "Odd");
+    }
+
+    volatile std::uint64_t failure_mask = 0;
+
+    [[gnu::noinline]] result<std::uint64_t> leaf(std::uint64_t x)
+    {
+        if(x & failure_mask)
+        {
+            return err(errors::odd_error{}, "odd input");
+        }
+
+        return ok(x + 1);
+    }
+
+    [[gnu::noinline]] result<std::uint64_t> middle(std::uint64_t x)
+    {
+        TRY_ASSIGN(const auto y, leaf(x));
+        return ok(y * 2);
+    }
+
+    void run(std::string_view variant)
+    {
+        std::uint64_t i = 0;
+
+        failure_mask = 0;
+        bench::measure(fmt::format("success path ({})", variant), 10'000'000, [&]()
+        {
+            bench::do_not_optimize(middle(++i).is_ok());
+        });
+
+        failure_mask = 1;
+        bench::measure(fmt::format("failure path, create + propagate + drop ({})", variant), 1'000'000, [&]()
+        {
+            bench::do_not_optimize(middle(++i).is_ok());
+        });
+    }
+}
+
+int main()
+{
+#ifdef ERR_TRACING
+    run("disabled");
+
+    error_tracing::enable();
+    run("enabled");
+    error_tracing::disable();
+    fmt::print("dropped {} events (buffers full)\n", error_tracing::dropped_events());
+#else
+    run(TRACE_VARIANT);
+#endif
+}
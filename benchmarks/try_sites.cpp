@@ -0,0 +1,86 @@
+//
+// Created by flori on 18.10.2026.
+//
+// Hot loop over many functions with many (never failing) TRY sites.
+// Built twice: with the default cold, outlined failure paths and with ERR_COLD=finline,
+// which inlines the failure construction into every site like before.
+
+#include <array>
+#include <climits>
+#include <utility>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+#ifndef TRY_SITES_VARIANT
+#define TRY_SITES_VARIANT "cold"
+#endif
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, overflow_error, "Overflow");
+    }
+
+    constexpr int sites_per_function = 32;
+    constexpr int function_count = 64;
+
+    volatile int failure_marker = INT_MIN;
+
+    inline result<int> step(int x)
+    {
+        if(x == failure_marker)
+        {
+            return err(errors::overflow_error{}, "step overflowed");
+        }
+
+        return ok(x + 1);
+    }
+
+#define TRY_STEP TRY_ASSIGN(x, step(x ^ N));
+#define TRY_STEP_4 TRY_STEP TRY_STEP TRY_STEP TRY_STEP
+#define TRY_STEP_32 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4 TRY_STEP_4
+
+    template<int N>
+    [[gnu::noinline]] result<int> hot_path(int x)
+    {
+        TRY_STEP_32
+        static_assert(sites_per_function == 32);
+        return ok(x);
+    }
+
+    template<std::size_t... N>
+    constexpr auto make_hot_paths(std::index_sequence<N...>)
+    {
+        return std::array<result<int>(*)(int), sizeof...(N)> { &hot_path<N>... };
+    }
+
+    const auto hot_paths = make_hot_paths(std::make_index_sequence<function_count>{});
+}
+
+int main()
+{
+    fmt::print("{} functions x {} TRY sites, failure paths {}\n",
+               function_count,
+               sites_per_function,
+               TRY_SITES_VARIANT);
+
+    bench::measure("all hot paths (round robin)", 20'000, []()
+    {
+        int x = 0;
+        for(const auto f : hot_paths)
+        {
+            x += f(x).get_value();
+        }
+        bench::do_not_optimize(x);
+    });
+
+    bench::measure("single hot path", 1'000'000, []()
+    {
+        bench::do_not_optimize(hot_paths[0](1).get_value());
+    });
+}
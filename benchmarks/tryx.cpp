@@ -0,0 +1,69 @@
+//
+// Created by flori on 18.10.2026.
+//
+// TRYX in expression position vs. TRY_ASSIGN for large values.
+
+#include <array>
+#include <cstdint>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, empty_error, "Empty");
+    }
+
+    struct large_value
+    {
+        std::array<std::uint64_t, 64> data;
+    };
+
+    volatile std::uint64_t seed = 1;
+
+    [[gnu::noinline]] result<large_value> make_large()
+    {
+        if(seed == 0)
+        {
+            return err(errors::empty_error{}, "no seed");
+        }
+
+        return ok_in_place<large_value>(large_value { { seed, seed + 1, seed + 2 } });
+    }
+
+    [[gnu::noinline]] std::uint64_t consume(const large_value& v)
+    {
+        return v.data[0] + v.data[1] + v.data[63];
+    }
+
+    [[gnu::noinline]] result<std::uint64_t> with_try_assign()
+    {
+        TRY_ASSIGN(const auto v, make_large());
+        return ok(consume(v));
+    }
+
+    [[gnu::noinline]] result<std::uint64_t> with_tryx_declaration()
+    {
+        const auto v = TRYX(make_large());
+        return ok(consume(v));
+    }
+
+    [[gnu::noinline]] result<std::uint64_t> with_tryx_expression()
+    {
+        return ok(consume(TRYX(make_large())));
+    }
+}
+
+int main()
+{
+    fmt::print("value size {} bytes\n", sizeof(large_value));
+
+    bench::measure("TRY_ASSIGN", 10'000'000, []() { bench::do_not_optimize(with_try_assign().get_value()); });
+    bench::measure("TRYX (declaration)", 10'000'000, []() { bench::do_not_optimize(with_tryx_declaration().get_value()); });
+    bench::measure("TRYX (expression position)", 10'000'000, []() { bench::do_not_optimize(with_tryx_expression().get_value()); });
+}
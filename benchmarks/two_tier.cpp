@@ -0,0 +1,95 @@
+//
+// Created by flori on 19.10.2026.
+//
+// a decoder whose fields fail often: small inline errors escalated at the boundary vs. error all the way down.
+
+#include <cstdint>
+#include <string_view>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, invalid_digit_error, "Not a decimal digit");
+    }
+
+    enum class decode_error : uint8_t
+    {
+        invalid_digit
+    };
+
+    [[maybe_unused]] constexpr error_code to_error_code(decode_error)
+    {
+        return errors::invalid_digit_error{};
+    }
+
+    // every other field is invalid
+    constexpr std::string_view fields[] = { "12345", "12x45", "99999", "x" };
+
+    template<class Error>
+    [[gnu::noinline]] result<int, Error> decode_digit(char c)
+    {
+        if(c < '0' || c > '9')
+        {
+            if constexpr(std::is_same_v<Error, error>)
+            {
+                return err(errors::invalid_digit_error{}, "invalid digit");
+            }
+            else
+            {
+                return err(decode_error::invalid_digit);
+            }
+        }
+
+        return ok(c - '0');
+    }
+
+    template<class Error>
+    result<int, Error> decode_field(std::string_view text)
+    {
+        int value = 0;
+        for(const auto c : text)
+        {
+            TRY_ASSIGN(const auto digit, decode_digit<Error>(c));
+            value = value * 10 + digit;
+        }
+
+        return ok(value);
+    }
+
+    // counts the invalid fields, the decoder's errors are handled in the loop
+    template<class Error>
+    [[gnu::noinline]] int decode_all()
+    {
+        int failed = 0;
+        for(const auto field : fields)
+        {
+            const auto r = decode_field<Error>(field);
+            failed += r.has_failed();
+        }
+        return failed;
+    }
+
+    // the boundary, only the failure that leaves the decoder is escalated
+    [[gnu::noinline]] result<int> decode_record(std::string_view text)
+    {
+        TRY_ASSIGN(const auto value, decode_field<decode_error>(text));
+        return ok(value);
+    }
+}
+
+int main()
+{
+    fmt::print("result<int, decode_error> {} bytes, result<int> {} bytes\n",
+               sizeof(result<int, decode_error>), sizeof(result<int>));
+
+    bench::measure("4 fields, small errors", 5'000'000, []() { bench::do_not_optimize(decode_all<decode_error>()); });
+    bench::measure("4 fields, error", 5'000'000, []() { bench::do_not_optimize(decode_all<error>()); });
+    bench::measure("escalated at the boundary", 5'000'000, []() { bench::do_not_optimize(decode_record("12x45").has_failed()); });
+}
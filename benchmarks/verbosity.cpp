@@ -0,0 +1,86 @@
+//
+// Created by flori on 19.10.2026.
+//
+// 64 functions with an EXPECT, a TRY and an err site each, every site with its own text.
+// built once per ERR_VERBOSITY, see CMakeLists.txt: compare the sizes of the binaries (target verbosity_size)
+// and the cost of failing, which formats the checked value into the explanation at ERR_VERBOSITY_FULL.
+
+#include <array>
+
+#include "../result.h"
+#include "../macros.h"
+
+#include "benchmark.h"
+
+namespace
+{
+    namespace errors
+    {
+        DEFINE_ERROR_CATEGORY(100, benchmark_category);
+        DEFINE_ERROR_CODE(1, benchmark_category, out_of_range, "Out of range");
+    }
+
+    volatile int limit = 1'000'000;
+
+    [[gnu::noinline]] result<int> bounded(int value, int step)
+    {
+        if(value > limit)
+        {
+            return err(errors::out_of_range{}, "value exceeds the limit of the bounded step");
+        }
+        return ok(value + step);
+    }
+
+#define VERBOSITY_STEP(n) \
+    [[gnu::noinline]] result<int> step_##n(int value) \
+    { \
+        EXPECT(value >= 0 && value != n * 7919, "step " #n " expects a non-negative value that is not reserved"); \
+        TRY_ASSIGN(const auto next, bounded(value * 3 + n, n)); \
+        if(next % 1024 == n) \
+        { \
+            return err(errors::out_of_range{}, "step " #n " produced a value reserved for the checksum"); \
+        } \
+        return ok(next); \
+    }
+
+#define VERBOSITY_STEP_8(n) \
+    VERBOSITY_STEP(n##0) VERBOSITY_STEP(n##1) VERBOSITY_STEP(n##2) VERBOSITY_STEP(n##3) \
+    VERBOSITY_STEP(n##4) VERBOSITY_STEP(n##5) VERBOSITY_STEP(n##6) VERBOSITY_STEP(n##7)
+
+    VERBOSITY_STEP_8(1) VERBOSITY_STEP_8(2) VERBOSITY_STEP_8(3) VERBOSITY_STEP_8(4)
+    VERBOSITY_STEP_8(5) VERBOSITY_STEP_8(6) VERBOSITY_STEP_8(7) VERBOSITY_STEP_8(8)
+
+#define VERBOSITY_REF_8(n) &step_##n##0, &step_##n##1, &step_##n##2, &step_##n##3, \
+                           &step_##n##4, &step_##n##5, &step_##n##6, &step_##n##7,
+
+    const std::array<result<int>(*)(int), 64> steps {
+        VERBOSITY_REF_8(1) VERBOSITY_REF_8(2) VERBOSITY_REF_8(3) VERBOSITY_REF_8(4)
+        VERBOSITY_REF_8(5) VERBOSITY_REF_8(6) VERBOSITY_REF_8(7) VERBOSITY_REF_8(8)
+    };
+}
+
+int main()
+{
+    fmt::print("ERR_VERBOSITY {}\n", ERR_VERBOSITY);
+
+    bench::measure("64 steps, all ok", 100'000, []()
+    {
+        int failed = 0;
+        for(int i = 0; i < 64; ++i)
+        {
+            failed += steps[i](i).has_failed();
+        }
+        bench::do_not_optimize(failed);
+    });
+
+    // every step fails its EXPECT
+    bench::measure("64 steps, all failing", 10'000, []()
+    {
+        int failed = 0;
+        for(int i = 0; i < 64; ++i)
+        {
+            failed += steps[i](-1).has_failed();
+        }
+        bench::do_not_optimize(failed);
+    });
+}
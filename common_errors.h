@@ -5,12 +5,18 @@
 #ifndef ERRORHANDLING_COMMON_ERRORS_H
 #define ERRORHANDLING_COMMON_ERRORS_H
 
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+
 #include "define_error.h"
 
 namespace basic_errors
 {
     DEFINE_ERROR_CATEGORY(1, basic_error_category);
     DEFINE_ERROR_CODE(1, basic_error_category, propagated_error, "Propagated error");
+    DEFINE_ERROR_CODE(2, basic_error_category, retries_exhausted, "Retries exhausted");
 }
 
 namespace assertion_errors
@@ -20,4 +26,73 @@ namespace assertion_errors
     DEFINE_ERROR_CODE(2, assertion_category, postcondition_error, "Post-condition failed");
 }
 
+// thrown by failed assertions if ASSERTIONS_TERMINATE is defined, by the default assertion handler
+class AssertionException
+        : public std::logic_error
+{
+public:
+    explicit AssertionException(error&& e)
+            : std::logic_error("Assertion make_failure")
+              , m_error(std::move(e))
+    {
+
+    }
+
+    [[nodiscard]] const error& get_error() const { return m_error; }
+
+private:
+    error m_error;
+};
+
+// called with the error of failed assertions if ASSERTIONS_TERMINATE is defined (EXPECT and ENSURE),
+// must not return. the process is aborted if it does
+using assertion_handler = void (*)(error&&);
+
+namespace assertion_handlers
+{
+#if ERR_EXCEPTIONS
+    [[noreturn]] inline void throw_exception(error&& e)
+    {
+        throw AssertionException(std::move(e));
+    }
+#endif
+
+    // runs the std::terminate_handler
+    [[noreturn]] inline void terminate(error&&) noexcept
+    {
+        std::terminate();
+    }
+
+    [[noreturn]] inline void abort(error&&) noexcept
+    {
+        std::abort();
+    }
+}
+
+namespace detail
+{
+    // throws AssertionException by default, terminates if exceptions are disabled
+    inline std::atomic<assertion_handler>& assertion_handler_slot() noexcept
+    {
+#if ERR_EXCEPTIONS
+        static std::atomic<assertion_handler> handler { &assertion_handlers::throw_exception };
+#else
+        static std::atomic<assertion_handler> handler { &assertion_handlers::terminate };
+#endif
+        return handler;
+    }
+
+    [[noreturn]] inline void fail_assertion(error&& e)
+    {
+        assertion_handler_slot().load(std::memory_order_acquire)(std::move(e));
+        std::abort();
+    }
+}
+
+// returns the previous handler
+inline assertion_handler set_assertion_handler(assertion_handler handler) noexcept
+{
+    return detail::assertion_handler_slot().exchange(handler, std::memory_order_acq_rel);
+}
+
 #endif //ERRORHANDLING_COMMON_ERRORS_H
@@ -0,0 +1,104 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_CONFIG_H
+#define ERRORHANDLING_CONFIG_H
+
+#include <gsl/assert>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define finline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define finline __forceinline
+#else
+#define finline
+#warning "no forcing of inlining is possible"
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#define ERR_LIKELY(x) __builtin_expect(!!(x), 1)
+#define ERR_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define ERR_LIKELY(x) (!!(x))
+#define ERR_UNLIKELY(x) (!!(x))
+#endif // defined(__clang__) || defined(__GNUC__)
+
+// failure construction is moved out of the hot functions into cold, never inlined helpers.
+// may be defined empty before including the library to keep failure paths inline (e.g. for comparison)
+#ifndef ERR_COLD
+#if defined(__clang__) || defined(__GNUC__)
+#define ERR_COLD [[gnu::cold]] [[gnu::noinline]]
+#elif defined(_MSC_VER)
+#define ERR_COLD __declspec(noinline)
+#else
+#define ERR_COLD
+#endif
+#endif // ERR_COLD
+
+// level of the checks of the library's own preconditions (get_value on a failed result, ...),
+// define ERR_CONTRACT_LEVEL before including the library to change it:
+//   ERR_CONTRACT_OFF       no checks at all
+//   ERR_CONTRACT_DEFAULT   the accessors of result check once, the storage below trusts them
+//   ERR_CONTRACT_AUDIT     the storage checks every access again
+// a failed check terminates, like GSL's Expects.
+#define ERR_CONTRACT_OFF 0
+#define ERR_CONTRACT_DEFAULT 1
+#define ERR_CONTRACT_AUDIT 2
+
+#ifndef ERR_CONTRACT_LEVEL
+#define ERR_CONTRACT_LEVEL ERR_CONTRACT_DEFAULT
+#endif
+
+#if ERR_CONTRACT_LEVEL >= ERR_CONTRACT_DEFAULT
+#define ERR_EXPECTS(cond) Expects(cond)
+#else
+#define ERR_EXPECTS(cond) do {} while(false)
+#endif
+
+#if ERR_CONTRACT_LEVEL >= ERR_CONTRACT_AUDIT
+#define ERR_AUDIT_EXPECTS(cond) Expects(cond)
+#else
+#define ERR_AUDIT_EXPECTS(cond) do {} while(false)
+#endif
+
+// the unchecked accessors only check in debug builds, independent of the level
+#ifndef NDEBUG
+#define ERR_DEBUG_EXPECTS(cond) Expects(cond)
+#else
+#define ERR_DEBUG_EXPECTS(cond) do {} while(false)
+#endif
+
+// exceptions and RTTI are used if the compiler has them enabled, builds with -fno-exceptions and -fno-rtti are supported.
+// define ERR_EXCEPTIONS or ERR_RTTI as 0 or 1 before including the library to override the detection.
+// without exceptions failed assertions go to the assertion handler (see set_assertion_handler) and
+// error::get_data of the wrong type terminates, RTTI is not needed at all since payloads name their type themselves.
+#ifndef ERR_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define ERR_EXCEPTIONS 1
+#else
+#define ERR_EXCEPTIONS 0
+#endif
+#endif // ERR_EXCEPTIONS
+
+// how much text the macros compile into the binary, define ERR_VERBOSITY before including the library to change it
+// (the same in every translation unit):
+//   ERR_VERBOSITY_CODES   errors only carry their code, no site
+//   ERR_VERBOSITY_LINES   codes, line numbers and site ids. file and function names, expressions and explanations
+//                         are left out, tools/error_sites.py maps the site ids back to them
+//   ERR_VERBOSITY_FULL    everything
+// below ERR_VERBOSITY_FULL the explanations of err, static_err, EXPECT and ENSURE are not evaluated
+// and the values checked by EXPECT and ENSURE are not formatted.
+#define ERR_VERBOSITY_CODES 0
+#define ERR_VERBOSITY_LINES 1
+#define ERR_VERBOSITY_FULL 2
+
+#ifndef ERR_VERBOSITY
+#define ERR_VERBOSITY ERR_VERBOSITY_FULL
+#endif
+
+// ERR_LATENCY (see latency.h) adds the creation time to every error and so changes the layout of error.
+// it has to be defined the same in every translation unit and shared object that passes errors to another one,
+// mixing them violates the one definition rule and corrupts errors at runtime without any diagnostic.
+
+#endif //ERRORHANDLING_CONFIG_H
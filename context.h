@@ -0,0 +1,172 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_CONTEXT_H
+#define ERRORHANDLING_CONTEXT_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+
+// breadcrumbs describing what a thread is working on, e.g. the request, shard or file offset.
+// a scope only links itself into a thread-local stack, its description is formatted when a TRY frame
+// propagates a failure and is attached to the error as error_context::breadcrumbs.
+//     error_context::scope ctx([&] { return fmt::format("shard {}", shard); });
+// the describe function must stay callable while the scope is alive, capturing by reference is fine.
+namespace error_context
+{
+    // data of the error that captured them, outermost scope first
+    struct breadcrumbs
+    {
+        breadcrumbs() = default;
+        breadcrumbs(breadcrumbs&&) noexcept = default;
+        breadcrumbs& operator=(breadcrumbs&&) noexcept = default;
+
+        breadcrumbs(const breadcrumbs& other)
+            : entries(other.entries, ::detail::current_failure_resource())
+            , thread(other.thread)
+            , serial(other.serial)
+        {
+        }
+
+        std::pmr::vector<std::pmr::string> entries { ::detail::current_failure_resource() };
+        const void* thread = nullptr; // stack of the capturing thread
+        uint64_t serial = 0; // of the innermost captured scope
+    };
+
+    namespace detail
+    {
+        struct frame
+        {
+            const frame* parent;
+            uint64_t serial; // increases from the bottom to the top of a stack
+            void (*describe)(const frame&, std::pmr::string&);
+        };
+
+        struct stack
+        {
+            const frame* top = nullptr;
+            uint64_t serial = 0;
+        };
+
+        inline stack& current_stack() noexcept
+        {
+            thread_local stack instance;
+            return instance;
+        }
+
+        // the latest capture of the chain, nullptr if there is none
+        inline const breadcrumbs* latest(const error& e)
+        {
+            for(auto node = &e; node; node = node->get_inner_error())
+            {
+                if(node->holds_data<breadcrumbs>())
+                {
+                    return &node->get_data<breadcrumbs>();
+                }
+            }
+            return nullptr;
+        }
+
+        // attaches the scopes that are not part of an earlier capture of the chain to e,
+        // which must not hold data yet. scopes pushed before the latest capture of the same thread
+        // and still alive were alive during that capture, they are skipped.
+        inline void capture(error& e)
+        {
+            const auto& s = current_stack();
+            if(s.top == nullptr)
+            {
+                return;
+            }
+
+            auto captured = uint64_t { 0 };
+            if(const auto earlier = latest(e); earlier && earlier->thread == &s)
+            {
+                captured = earlier->serial;
+            }
+
+            if(s.top->serial <= captured)
+            {
+                return;
+            }
+
+            std::size_t count = 0;
+            for(auto f = s.top; f && f->serial > captured; f = f->parent)
+            {
+                ++count;
+            }
+
+            breadcrumbs crumbs;
+            crumbs.thread = &s;
+            crumbs.serial = s.top->serial;
+            crumbs.entries.resize(count);
+            for(auto f = s.top; count != 0; f = f->parent)
+            {
+                f->describe(*f, crumbs.entries[--count]);
+            }
+
+            e.set_data(std::move(crumbs));
+        }
+    }
+
+    // costs a few stores on construction and destruction, describe is only invoked on failure
+    template<class F>
+    class scope
+        : detail::frame
+    {
+    public:
+        explicit scope(F describe)
+            : scope(detail::current_stack(), std::move(describe))
+        {
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+        ~scope() { detail::current_stack().top = parent; }
+
+    private:
+        scope(detail::stack& s, F describe)
+            : detail::frame { s.top, ++s.serial, &describe_with }
+            , m_describe(std::move(describe))
+        {
+            s.top = this;
+        }
+
+        static void describe_with(const detail::frame& f, std::pmr::string& out)
+        {
+            const auto& text = static_cast<const scope&>(f).m_describe();
+            out.assign(std::string_view(text));
+        }
+
+        F m_describe;
+    };
+
+    // all breadcrumbs of an error chain, outermost scope first
+    inline std::vector<std::string_view> collect(const error& e)
+    {
+        std::vector<const breadcrumbs*> captures;
+        for(auto node = &e; node; node = node->get_inner_error())
+        {
+            if(node->holds_data<breadcrumbs>())
+            {
+                captures.push_back(&node->get_data<breadcrumbs>());
+            }
+        }
+
+        // earlier captures are further down the chain and hold the outer scopes
+        std::vector<std::string_view> entries;
+        for(auto it = captures.rbegin(); it != captures.rend(); ++it)
+        {
+            entries.insert(entries.end(), (*it)->entries.begin(), (*it)->entries.end());
+        }
+        return entries;
+    }
+}
+
+#endif //ERRORHANDLING_CONTEXT_H
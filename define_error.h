@@ -6,18 +6,6 @@
 #define ERRORHANDLING_DEFINE_ERROR_H
 
 #include "error.h"
-
-#define DEFINE_ERROR_CATEGORY(id, name) \
-    struct name : error_category_base<id>\
-    {\
-        constexpr name()\
-            : error_category_base<id>(#name) {}\
-    }
-
-#define DEFINE_ERROR_CODE(id, category, name, description) \
-    struct name : error_code_base<id, category>\
-    {                           \
-        constexpr name() : error_code_base<id, category>(#name, description) {}\
-    }
+#include "result_macros.h"
 
 #endif //ERRORHANDLING_DEFINE_ERROR_H
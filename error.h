@@ -5,28 +5,46 @@
 #ifndef ERRORHANDLING_ERROR_H
 #define ERRORHANDLING_ERROR_H
 
-#include <sstream>
-#include <cxxabi.h>
-#include <any>
+#include <source_location>
+#include <string>
+#include <utility>
+
+#include "config.h"
+#include "memory.h"
+#include "payload.h"
+#include "trace.h"
+#include "latency.h"
 
 //#include <backward.hpp>
 
+// whether an operation failing with a given error code may succeed when it is retried
+enum class retry_trait : uint8_t
+{
+    permanent,  // retrying will not help
+    transient,  // retry after a short backoff
+    throttled   // retry after a longer backoff, the callee asked to slow down
+};
+
 struct error_category
 {
 public:
     constexpr error_category(const int32_t id,
-                             const std::string_view name)
+                             const std::string_view name,
+                             const retry_trait retry = retry_trait::permanent)
         : m_id(id)
+        , m_retry(retry)
         , m_name(name)
     {
     }
 
     [[nodiscard]] constexpr auto get_id() const -> int32_t { return m_id; }
     [[nodiscard]] constexpr auto get_name() const -> std::string_view { return m_name; }
+    [[nodiscard]] constexpr auto get_retry_trait() const -> retry_trait { return m_retry; }
     [[nodiscard]] constexpr bool operator==(const error_category& rhs) const { return m_id == rhs.m_id; }
 
 private:
     int32_t m_id;
+    retry_trait m_retry;
     std::string_view m_name;
 };
 
@@ -34,8 +52,10 @@ template<uint32_t Id>
 struct error_category_base
     : error_category
 {
-    explicit constexpr error_category_base(std::string_view name)
-        : error_category(Id, name) {}
+    explicit constexpr error_category_base(std::string_view name, retry_trait retry = retry_trait::permanent)
+        : error_category(Id, name, retry) {}
+
+    static constexpr uint32_t id = Id;
 };
 
 template<uint32_t LocalId, uint32_t CategoryId>
@@ -51,10 +71,20 @@ public:
                          const uint64_t global_id,
                          const std::string_view name,
                          const std::string_view description)
+        : error_code(category, global_id, name, description, category.get_retry_trait())
+    {
+    }
+
+    constexpr error_code(const error_category category,
+                         const uint64_t global_id,
+                         const std::string_view name,
+                         const std::string_view description,
+                         const retry_trait retry)
         : m_category(category)
         , m_global_id(global_id)
         , m_name(name)
         , m_description(description)
+        , m_retry(retry)
     {
     }
 
@@ -62,6 +92,7 @@ public:
     [[nodiscard]] finline constexpr auto get_id() const -> uint64_t { return m_global_id; }
     [[nodiscard]] finline constexpr auto get_name() const -> std::string_view { return m_name; }
     [[nodiscard]] finline constexpr auto get_description() const -> std::string_view { return m_description; }
+    [[nodiscard]] finline constexpr auto get_retry_trait() const -> retry_trait { return m_retry; }
     [[nodiscard]] finline constexpr operator uint64_t() const { return m_global_id; } // NOLINT(google-explicit-constructor)
 
 private:
@@ -69,14 +100,16 @@ private:
     uint64_t m_global_id;
     std::string_view m_name;
     std::string_view m_description;
+    retry_trait m_retry;
 };
 
 template<uint32_t LocalId, class Category>
 struct error_code_base : error_code
 {
     explicit constexpr error_code_base(const std::string_view name,
-                                       const std::string_view description)
-        : error_code(Category{}, id, name, description)
+                                       const std::string_view description,
+                                       const retry_trait retry = Category{}.get_retry_trait())
+        : error_code(Category{}, id, name, description, retry)
     {
     }
 
@@ -90,96 +123,253 @@ struct source_location
     int line;
 };
 
+// compile-time constant description of the site an error was created or propagated at.
+// the macros emit one static instance per expansion and errors only point to it,
+// its address is a stable key of the site, e.g. for deduplication or instrumentation.
+// the texts are empty when they are stripped by ERR_VERBOSITY.
+struct error_site
+{
+    const char* file;
+    int line;
+    std::string_view function; // enclosing function, compiler specific spelling
+    const char* expression;    // of TRY / EXPECT / ENSURE, empty for err
+    const char* code;          // of err as written, empty for TRY
+    uint64_t id = 0;           // detail::site_id of file and line, 0 if unknown
+
+    [[nodiscard]] constexpr auto get_origin() const -> source_location { return { file, line }; }
+    [[nodiscard]] constexpr bool is_stripped() const { return *file == '\0' && id != 0; }
+};
+
+namespace detail
+{
+    // FNV-1a of "file:line", the same as tools/error_sites.py computes from the sources.
+    // evaluated at compile time, file does not end up in the binary when it is stripped
+    [[nodiscard]] constexpr uint64_t site_id(std::string_view file, int line)
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        const auto add = [&hash](char c)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3;
+        };
+
+        for(const auto c : file)
+        {
+            add(c);
+        }
+        add(':');
+
+        char digits[12] {};
+        int count = 0;
+        for(auto n = static_cast<unsigned>(line); count == 0 || n != 0; n /= 10)
+        {
+            digits[count++] = static_cast<char>('0' + n % 10);
+        }
+        while(count != 0)
+        {
+            add(digits[--count]);
+        }
+        return hash;
+    }
+
+    // std::source_location names the lambda that holds a site descriptor, e.g. "parse(int)::<lambda()>" (GCC)
+    [[nodiscard]] constexpr std::string_view enclosing_function(std::string_view name)
+    {
+        constexpr std::string_view lambda = "::<lambda()>";
+        while(name.ends_with(lambda))
+        {
+            name.remove_suffix(lambda.size());
+        }
+        return name;
+    }
+
+    // for errors created without a site, e.g. small errors escalated outside of a TRY frame
+    inline constexpr error_site unknown_site { "", 0, "", "", "" };
+
+    // small error types (enums, ...) name their error_code with a to_error_code overload found by ADL,
+    // error codes themselves are used as they are
+    template<class E>
+    concept has_error_code = std::is_convertible_v<const E&, error_code> ||
+                             requires(const E& e) { { to_error_code(e) } -> std::convertible_to<error_code>; };
+
+    template<has_error_code E>
+    constexpr error_code code_of(const E& e)
+    {
+        if constexpr(std::is_convertible_v<const E&, error_code>)
+        {
+            return e;
+        }
+        else
+        {
+            return to_error_code(e);
+        }
+    }
+}
+
+namespace detail
+{
+    struct code_id_kind {};
+    struct category_id_kind {};
+
+    template<class Kind, uint64_t Id>
+    struct error_id_tag {};
+
+    // instantiated by DEFINE_ERROR_CODE and DEFINE_ERROR_CATEGORY for every definition.
+    // a second definition with the same id in a translation unit defines error_id_defined
+    // for the same tag again, which does not compile ("redefinition of error_id_defined")
+    template<class Kind, uint64_t Id, class Definition>
+    struct unique_error_id
+    {
+        friend constexpr bool error_id_defined(error_id_tag<Kind, Id>) { return true; }
+
+        static constexpr bool value = true;
+    };
+}
+
+namespace basic_errors
+{
+    struct propagated_error;
+}
+
 class error
 {
 public:
     template<class ErrorCode>
-    error(ErrorCode&& code, source_location origin)
-        : error(std::forward<ErrorCode&&>(code), {}, nullptr, origin)
+    error(ErrorCode&& code, const error_site& site)
+        : error(std::forward<ErrorCode&&>(code), {}, nullptr, site)
     {
 //        m_bt.load_here();
     }
 
     template<class ErrorCode>
-    error(ErrorCode&& code, std::string explanation, source_location origin)
-        : error(std::forward<ErrorCode&&>(code), std::move(explanation), nullptr, origin)
+    error(ErrorCode&& code, std::string_view explanation, const error_site& site)
+        : error(std::forward<ErrorCode&&>(code), explanation, nullptr, site)
     {
 //        m_bt.load_here();
     }
 
     template<class ErrorCode>
-    error(ErrorCode&& code, std::unique_ptr<error>&& inner_error, source_location origin)
-        : error(std::forward<ErrorCode&&>(code), {}, std::move(inner_error), origin)
+    error(ErrorCode&& code, failure_ptr<error>&& inner_error, const error_site& site)
+        : error(std::forward<ErrorCode&&>(code), {}, std::move(inner_error), site)
     {
     }
 
     template<class ErrorCode>
     error(ErrorCode&& code,
-          std::string explanation,
-          std::unique_ptr<error>&& inner_error,
-          source_location origin)
+          std::string_view explanation,
+          failure_ptr<error>&& inner_error,
+          const error_site& site)
         : m_code(std::forward<ErrorCode&&>(code))
-        , m_origin(origin)
-        , m_explanation(std::move(explanation))
+        , m_site(&site)
+        , m_explanation(explanation, detail::current_failure_resource())
         , m_inner_error(std::move(inner_error))
     {
+        trace_construction<ErrorCode>();
     }
 
     template<class ErrorCode, class Data>
     error(ErrorCode&& code,
-          std::string explanation,
-          std::unique_ptr<error>&& inner_error,
-          source_location origin,
+          std::string_view explanation,
+          failure_ptr<error>&& inner_error,
+          const error_site& site,
           Data&& data)
         : m_code(std::forward<ErrorCode&&>(code))
-        , m_origin(origin)
-        , m_explanation(std::move(explanation))
+        , m_site(&site)
+        , m_explanation(explanation, detail::current_failure_resource())
         , m_inner_error(std::move(inner_error))
         , m_data(std::forward<Data>(data))
     {
+        trace_construction<ErrorCode>();
     }
 
-    error(error&& e, std::unique_ptr<error>&& inner_error)
+    // errors only point to their site, which has to outlive them: a static descriptor of ERROR_SITE or FAILURE_SITE
+    template<class ErrorCode>
+    error(ErrorCode&&, error_site&&) = delete;
+    template<class ErrorCode>
+    error(ErrorCode&&, std::string_view, error_site&&) = delete;
+    template<class ErrorCode>
+    error(ErrorCode&&, failure_ptr<error>&&, error_site&&) = delete;
+    template<class ErrorCode>
+    error(ErrorCode&&, std::string_view, failure_ptr<error>&&, error_site&&) = delete;
+    template<class ErrorCode, class Data>
+    error(ErrorCode&&, std::string_view, failure_ptr<error>&&, error_site&&, Data&&) = delete;
+
+    error(error&& e, failure_ptr<error>&& inner_error)
         : error(std::move(e))
     {
         m_inner_error = std::move(inner_error);
     }
 
+    error(error&&) noexcept = default;
+    error& operator=(error&&) noexcept = default;
+
+    // copy of this node sharing the inner chain, used for copy-on-write of shared errors
+    [[nodiscard]] error clone() const { return error(*this); }
+
     [[nodiscard]] finline auto get_code() const -> const error_code& { return m_code; }
     [[nodiscard]] finline auto get_explanation() const -> std::string_view { return m_explanation; }
-    [[nodiscard]] finline auto get_origin() const -> const source_location& { return m_origin; }
+    [[nodiscard]] finline auto get_site() const -> const error_site& { return *m_site; }
+    [[nodiscard]] finline auto get_origin() const -> source_location { return m_site->get_origin(); }
     [[nodiscard]] finline auto get_inner_error() const -> const error* { return m_inner_error.get(); }
     [[nodiscard]] finline operator uint64_t() const { return m_code.get_id(); } // NOLINT(google-explicit-constructor)
+#ifdef ERR_LATENCY
+    [[nodiscard]] finline auto get_creation_time() const -> int64_t { return m_created; } // see error_latency::now()
+    finline void set_creation_time(int64_t time) { m_created = time; }
+#endif
 
     template<typename T>
-    [[nodiscard]] finline auto get_data() -> T& { return any_cast<T&>(m_data); }
+    [[nodiscard]] finline auto get_data() -> T& { return m_data.get<T>(); }
 
     template<typename T>
-    [[nodiscard]] finline auto get_data() const -> const T& { return any_cast<const T&>(m_data); }
+    [[nodiscard]] finline auto get_data() const -> const T& { return m_data.get<T>(); }
 
     [[nodiscard]] finline bool has_data() const { return m_data.has_value(); }
-    [[nodiscard]] finline auto get_data_type() const -> std::string_view { return m_data.type().name(); }
 
     template<typename T>
-    finline error& set_data(T&& data) { m_data = std::forward<T&&>(data); return *this; }
+    [[nodiscard]] finline bool holds_data() const { return m_data.holds<T>(); }
+    [[nodiscard]] finline auto get_data_type() const -> std::string_view { return m_data.type_name(); }
 
-    finline error& set_inner_error(std::unique_ptr<error> inner) { m_inner_error = std::move(inner); return *this; }
+    template<typename T>
+    finline error& set_data(T&& data) { m_data = detail::payload(std::forward<T&&>(data)); return *this; }
+
+    finline error& set_inner_error(failure_ptr<error> inner) { m_inner_error = std::move(inner); return *this; }
 
 private:
+    error(const error& other)
+        : m_code(other.m_code)
+        , m_site(other.m_site)
+        , m_explanation(other.m_explanation, detail::current_failure_resource())
+        , m_inner_error(other.m_inner_error.share())
+        , m_data(other.m_data.clone())
+#ifdef ERR_LATENCY
+        , m_created(other.m_created)
+#endif
+    {
+    }
+
+    // TRY frames construct propagated errors, they are traced as propagation of the inner error
+    template<class ErrorCode>
+    finline void trace_construction() const
+    {
+        if constexpr(std::is_same_v<std::decay_t<ErrorCode>, basic_errors::propagated_error>)
+        {
+            ERR_TRACE(trace_event_kind::propagate, m_inner_error ? m_inner_error->m_code : m_code, get_origin());
+        }
+        else
+        {
+            ERR_TRACE(trace_event_kind::create, m_code, get_origin());
+        }
+    }
+
     error_code m_code;
-    source_location m_origin;
-    std::string m_explanation;
-    std::unique_ptr<error> m_inner_error;
-    std::any m_data;
+    const error_site* m_site; // static, see error_site
+    std::pmr::string m_explanation; // allocated from the failure resource, see failure_memory_scope
+    failure_ptr<error> m_inner_error;
+    detail::payload m_data;
+#ifdef ERR_LATENCY
+    int64_t m_created = error_latency::now();
+#endif
 //    backward::StackTrace m_bt;
 };
 
-template<auto> struct _size{};
-
-_size<sizeof(error)> s;
-_size<sizeof(std::any)> s1;
-_size<sizeof(std::string)> s2;
-_size<sizeof(std::unique_ptr<error>)> s3;
-_size<sizeof(error_code)> s4;
-
 #endif //ERRORHANDLING_ERROR_H
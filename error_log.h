@@ -0,0 +1,262 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_ERROR_LOG_H
+#define ERRORHANDLING_ERROR_LOG_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "config.h"
+#include "formatting.h"
+
+// logging of unhandled errors that stays cheap during incidents, when the same failure repeats millions of times.
+// failures are deduplicated by a fingerprint of their chain (code ids and origins), the first first_n failures
+// of a fingerprint per interval are written in full, the rest are counted and summarized as
+//     suppressed 1234 similar errors: 'connection_reset' at client.cpp:42
+// when the interval is over. the summaries are written by the next failure of any fingerprint or by flush(),
+// which should also be called periodically if failures may stop altogether.
+namespace error_log
+{
+    struct options
+    {
+        uint32_t first_n = 10; // written per fingerprint and interval
+        std::chrono::nanoseconds interval = std::chrono::seconds(10);
+        void (*write)(std::string_view) = [](std::string_view text) { std::fwrite(text.data(), 1, text.size(), stderr); };
+        int64_t (*now)() = []() -> int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+    };
+
+    namespace detail
+    {
+        inline options& get_options()
+        {
+            static options instance;
+            return instance;
+        }
+
+        struct fingerprint_entry
+        {
+            uint64_t fingerprint;
+            std::string_view name; // of the root cause
+            const error_site* site;
+            std::atomic<int64_t> window_start;
+            std::atomic<uint32_t> written { 0 }; // in the current window
+            std::atomic<uint64_t> suppressed { 0 };
+        };
+
+        // open addressing over fingerprints, entries are allocated on first use and never freed.
+        // fingerprints beyond the capacity share the overflow entry and are limited together.
+        constexpr std::size_t table_size = 1024;
+
+        struct table
+        {
+            std::array<std::atomic<fingerprint_entry*>, table_size> entries {};
+            fingerprint_entry overflow { .fingerprint = 0, .name = "other errors", .site = &::detail::unknown_site, .window_start = 0 };
+            std::atomic<int64_t> last_sweep { 0 };
+        };
+
+        inline table& get_table()
+        {
+            static table instance;
+            return instance;
+        }
+
+        [[nodiscard]] constexpr uint64_t mix(uint64_t hash, uint64_t value)
+        {
+            hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+
+        // code ids and sites of the whole chain, sites are compared by the address of their static descriptor
+        [[nodiscard]] inline uint64_t fingerprint(const error& e)
+        {
+            uint64_t hash = 0;
+            for(auto node = &e; node; node = node->get_inner_error())
+            {
+                hash = mix(hash, node->get_code().get_id());
+                hash = mix(hash, reinterpret_cast<uintptr_t>(&node->get_site()));
+            }
+            return hash;
+        }
+
+        inline fingerprint_entry& find_or_insert(uint64_t fingerprint, std::string_view name, const error_site& site, int64_t now)
+        {
+            auto& t = get_table();
+            for(std::size_t probe = 0; probe < table_size; ++probe)
+            {
+                auto& slot = t.entries[(fingerprint + probe) % table_size];
+
+                auto entry = slot.load(std::memory_order_acquire);
+                if(entry == nullptr)
+                {
+                    const auto created = new fingerprint_entry { .fingerprint = fingerprint, .name = name, .site = &site, .window_start = now };
+                    if(slot.compare_exchange_strong(entry, created, std::memory_order_acq_rel))
+                    {
+                        return *created;
+                    }
+                    delete created;
+                }
+
+                if(entry->fingerprint == fingerprint)
+                {
+                    return *entry;
+                }
+            }
+
+            return t.overflow;
+        }
+
+        // small errors and the overflow entry have no site
+        inline void write_summary(const fingerprint_entry& entry, uint64_t suppressed)
+        {
+            if(entry.site == &::detail::unknown_site)
+            {
+                get_options().write(fmt::format("suppressed {} similar errors: '{}'\n", suppressed, entry.name));
+                return;
+            }
+            get_options().write(fmt::format("suppressed {} similar errors: '{}' at {}\n", suppressed, entry.name, *entry.site));
+        }
+
+        // starts a new window after the interval and writes the summary of the previous one.
+        // counts are approximate while a window rolls over
+        inline void roll_window(fingerprint_entry& entry, int64_t now)
+        {
+            auto start = entry.window_start.load(std::memory_order_relaxed);
+            if(now - start >= get_options().interval.count() &&
+               entry.window_start.compare_exchange_strong(start, now, std::memory_order_relaxed))
+            {
+                entry.written.store(0, std::memory_order_relaxed);
+                if(const auto suppressed = entry.suppressed.exchange(0, std::memory_order_relaxed))
+                {
+                    write_summary(entry, suppressed);
+                }
+            }
+        }
+
+        // once per interval the windows of all fingerprints are rolled over,
+        // so bursts that stopped are summarized as well
+        inline void sweep(int64_t now)
+        {
+            auto& t = get_table();
+            auto last = t.last_sweep.load(std::memory_order_relaxed);
+            if(now - last < get_options().interval.count() ||
+               !t.last_sweep.compare_exchange_strong(last, now, std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            for(auto& slot : t.entries)
+            {
+                if(const auto entry = slot.load(std::memory_order_acquire))
+                {
+                    roll_window(*entry, now);
+                }
+            }
+            roll_window(t.overflow, now);
+        }
+
+        // whether the failure is to be written
+        inline bool admit(fingerprint_entry& entry, int64_t now)
+        {
+            sweep(now);
+            roll_window(entry, now);
+
+            if(entry.written.fetch_add(1, std::memory_order_relaxed) < get_options().first_n)
+            {
+                return true;
+            }
+
+            entry.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        ERR_COLD inline void log(const error& e)
+        {
+            auto root = &e;
+            while(root->get_inner_error() != nullptr)
+            {
+                root = root->get_inner_error();
+            }
+
+            const auto now = get_options().now();
+            auto& entry = find_or_insert(fingerprint(e), root->get_code().get_name(), root->get_site(), now);
+            if(admit(entry, now))
+            {
+                get_options().write(fmt::format("{}\n", e));
+            }
+        }
+
+        // small errors have no chain or origin, their code is the fingerprint
+        template<class R>
+        ERR_COLD void log_inline(const R& r)
+        {
+            const auto code = ::detail::code_of(r.unchecked_error());
+            const auto now = get_options().now();
+            auto& entry = find_or_insert(code.get_id(), code.get_name(), ::detail::unknown_site, now);
+            if(admit(entry, now))
+            {
+                get_options().write(fmt::format("{}\n", r));
+            }
+        }
+    }
+
+    // to be called before the first failure is logged
+    inline void configure(const options& o)
+    {
+        detail::get_options() = o;
+    }
+
+    // writes the summaries of all suppressed failures, e.g. periodically or at shutdown
+    inline void flush()
+    {
+        auto& t = detail::get_table();
+        for(auto& slot : t.entries)
+        {
+            if(const auto entry = slot.load(std::memory_order_acquire))
+            {
+                if(const auto suppressed = entry->suppressed.exchange(0, std::memory_order_relaxed))
+                {
+                    detail::write_summary(*entry, suppressed);
+                }
+            }
+        }
+
+        if(const auto suppressed = t.overflow.suppressed.exchange(0, std::memory_order_relaxed))
+        {
+            detail::write_summary(t.overflow, suppressed);
+        }
+    }
+
+    // final action writing the failed results it sees, e.g. result<int, error, error_log::final_action>
+    struct final_action
+    {
+        template<class R>
+        void operator()(const R& r) const noexcept
+        {
+            if(ERR_UNLIKELY(r.has_failed()))
+            {
+                if constexpr(::detail::is_inline_error_v<std::remove_cvref_t<decltype(r.unchecked_error())>>)
+                {
+                    detail::log_inline(r);
+                }
+                else
+                {
+                    detail::log(r.unchecked_error());
+                }
+            }
+        }
+    };
+}
+
+#endif //ERRORHANDLING_ERROR_LOG_H
@@ -5,7 +5,25 @@
 #define ERRORHANDLING_FORMATTING_H
 
 #include "result.h"
+#include "context.h"
 #include <fmt/format.h>
+#include <fmt/ranges.h>
+
+// file:line, or the site id and line of sites stripped by ERR_VERBOSITY, which tools/error_sites.py resolves
+template<>
+struct fmt::formatter<error_site>
+    : formatter<string_view>
+{
+    template <typename FormatContext>
+    auto format(const error_site& site, FormatContext& ctx)
+    {
+        if(site.is_stripped())
+        {
+            return format_to(ctx.out(), "site#{:016x}:{}", site.id, site.line);
+        }
+        return format_to(ctx.out(), "{}:{}", site.file, site.line);
+    }
+};
 
 template<>
 struct fmt::formatter<error>
@@ -33,7 +51,7 @@ struct fmt::formatter<error>
         const auto format = [&ctx, &e = *inner, &indent, cause]()
         {
             return format_to(ctx.out(),
-                            "{}{}'{}' at {}:{}\n"
+                            "{}{}'{}' at {}\n"
                             "{}    Description:     {}\n"
                             "{}"
                             "{}    Category:        {}\n"
@@ -41,8 +59,7 @@ struct fmt::formatter<error>
                             indent.data(),
                             cause ? "| caused by " : "",
                             e.get_code().get_name(),
-                            e.get_origin().file,
-                            e.get_origin().line,
+                            e.get_site(),
                             indent.data(),
                             e.get_code().get_description(),
                             e.get_explanation().empty()
@@ -54,9 +71,13 @@ struct fmt::formatter<error>
                             e.get_code().get_category().get_name(),
                             !e.has_data()
                                 ? ""
-                                : fmt::format("{}    error data type: {}\n",
-                                              indent.data(),
-                                              e.get_data_type()));
+                                : e.holds_data<error_context::breadcrumbs>()
+                                    ? fmt::format("{}    Context:         {}\n",
+                                                  indent.data(),
+                                                  fmt::join(e.get_data<error_context::breadcrumbs>().entries, " > "))
+                                    : fmt::format("{}    error data type: {}\n",
+                                                  indent.data(),
+                                                  e.get_data_type()));
         };
 
         auto it = format();
@@ -68,10 +89,12 @@ struct fmt::formatter<error>
             std::for_each(cbegin(propagations), cend(propagations), [&](auto p)
             {
                 it = format_to(ctx.out(),
-                               "{}    | at {}:{}\n",
+                               "{}    | at {}{}\n",
                                indent.data(),
-                               p->get_origin().file,
-                               p->get_origin().line);
+                               p->get_site(),
+                               !p->template holds_data<error_context::breadcrumbs>()
+                                   ? ""
+                                   : fmt::format(" in {}", fmt::join(p->template get_data<error_context::breadcrumbs>().entries, " > ")));
             });
         }
 
@@ -115,4 +138,29 @@ struct fmt::formatter<result<V, error, L>>
     }
 };
 
+// small inline errors have no origin or chain, only their error code is printed
+template <class V, class E, class L>
+    requires ::detail::is_inline_error_v<E> && ::detail::has_error_code<E>
+struct fmt::formatter<result<V, E, L>>
+    : formatter<string_view>
+{
+    template <typename FormatContext>
+    auto format(const result<V, E, L>& r, FormatContext& ctx)
+    {
+        if(r.is_ok())
+        {
+            return format_to(ctx.out(), "ok");
+        }
+
+        const auto code = ::detail::code_of(r.get_error());
+        return format_to(ctx.out(),
+                         "'{}'\n"
+                         "    Description:     {}\n"
+                         "    Category:        {}\n",
+                         code.get_name(),
+                         code.get_description(),
+                         code.get_category().get_name());
+    }
+};
+
 #endif //ERRORHANDLING_FORMATTING_H
@@ -0,0 +1,280 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_LATENCY_H
+#define ERRORHANDLING_LATENCY_H
+
+// opt-in time-to-handle measurement, define ERR_LATENCY before including the library to compile it in.
+// every error then carries its creation time, and the age of the root cause of a chain is recorded
+// when the chain is passed to handle_error or dropped by a result, in log-linear histograms per error code.
+// without ERR_LATENCY errors have no timestamp member and nothing is recorded.
+#ifdef ERR_LATENCY
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#if defined(__linux__)
+#include <ctime>
+#endif
+
+#include <fmt/format.h>
+
+#include "config.h"
+
+namespace error_latency
+{
+    // nanoseconds. CLOCK_MONOTONIC_COARSE is read from the vDSO without a syscall,
+    // its resolution is the kernel tick (1-4 ms). define ERR_LATENCY_PRECISE_CLOCK for the steady clock
+    [[nodiscard]] inline int64_t now() noexcept
+    {
+#if defined(__linux__) && !defined(ERR_LATENCY_PRECISE_CLOCK)
+        timespec ts {};
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // creation time of static errors (see static_err) and their copies, which are created once and
+    // have no age of their own. they are not recorded
+    constexpr int64_t untimed = 0;
+
+    // HDR-style log-linear histogram: values below 16 are exact, above that every power of two
+    // is split into 16 buckets, i.e. a relative error of at most 6.25%. recording is wait-free.
+    class histogram
+    {
+    public:
+        static constexpr unsigned sub_bucket_bits = 4;
+        static constexpr unsigned sub_buckets = 1u << sub_bucket_bits;
+        static constexpr unsigned bucket_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+        void record(uint64_t value)
+        {
+            m_buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+
+            auto max = m_max.load(std::memory_order_relaxed);
+            while(value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        [[nodiscard]] uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+        // highest value equivalent to the bucket containing the given quantile (0..1)
+        [[nodiscard]] uint64_t value_at(double quantile) const
+        {
+            const auto total = count();
+            if(total == 0)
+            {
+                return 0;
+            }
+
+            const auto rank = std::max<uint64_t>(static_cast<uint64_t>(quantile * static_cast<double>(total) + 0.5), 1);
+            uint64_t seen = 0;
+            for(unsigned i = 0; i < bucket_count; ++i)
+            {
+                seen += m_buckets[i].load(std::memory_order_relaxed);
+                if(seen >= rank)
+                {
+                    return std::min(highest_equivalent(i), max());
+                }
+            }
+
+            return max();
+        }
+
+        [[nodiscard]] static constexpr unsigned index_of(uint64_t value)
+        {
+            if(value < sub_buckets)
+            {
+                return static_cast<unsigned>(value);
+            }
+
+            const auto exponent = static_cast<unsigned>(std::bit_width(value)) - 1;
+            const auto sub = static_cast<unsigned>(value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+            return (exponent - sub_bucket_bits + 1) * sub_buckets + sub;
+        }
+
+        [[nodiscard]] static constexpr uint64_t lowest_equivalent(unsigned index)
+        {
+            if(index < sub_buckets)
+            {
+                return index;
+            }
+
+            const auto exponent = index / sub_buckets + sub_bucket_bits - 1;
+            return (uint64_t { sub_buckets } + index % sub_buckets) << (exponent - sub_bucket_bits);
+        }
+
+        [[nodiscard]] static constexpr uint64_t highest_equivalent(unsigned index)
+        {
+            return index + 1 < bucket_count ? lowest_equivalent(index + 1) - 1 : UINT64_MAX;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, bucket_count> m_buckets {};
+        std::atomic<uint64_t> m_count { 0 };
+        std::atomic<uint64_t> m_max { 0 };
+    };
+
+    static_assert(histogram::index_of(15) == 15);
+    static_assert(histogram::index_of(16) == 16 && histogram::lowest_equivalent(16) == 16);
+    static_assert(histogram::lowest_equivalent(histogram::index_of(1'000'000)) <= 1'000'000);
+    static_assert(histogram::highest_equivalent(histogram::index_of(1'000'000)) >= 1'000'000);
+    static_assert(histogram::index_of(UINT64_MAX) == histogram::bucket_count - 1);
+
+    struct code_latency
+    {
+        uint64_t code;
+        std::string_view name;
+        histogram handled; // age when passed to handle_error
+        histogram dropped; // age when the result holding it was destroyed
+    };
+
+    namespace detail
+    {
+        // open addressing over code ids, entries are allocated on first use and never freed.
+        // codes beyond the capacity are not recorded.
+        constexpr std::size_t table_size = 512;
+
+        struct table
+        {
+            std::array<std::atomic<code_latency*>, table_size> entries {};
+        };
+
+        inline table& get_table()
+        {
+            static table instance;
+            return instance;
+        }
+
+        inline code_latency* find_or_insert(uint64_t code, std::string_view name)
+        {
+            auto& entries = get_table().entries;
+            for(std::size_t probe = 0; probe < table_size; ++probe)
+            {
+                auto& slot = entries[(code + probe) % table_size];
+
+                auto entry = slot.load(std::memory_order_acquire);
+                if(entry == nullptr)
+                {
+                    const auto created = new code_latency { .code = code, .name = name, .handled = {}, .dropped = {} };
+                    if(slot.compare_exchange_strong(entry, created, std::memory_order_acq_rel))
+                    {
+                        return created;
+                    }
+                    delete created;
+                }
+
+                if(entry->code == code)
+                {
+                    return entry;
+                }
+            }
+
+            return nullptr;
+        }
+
+        template<class Error>
+        ERR_COLD void record(const Error& e, bool handled)
+        {
+            auto root = &e;
+            while(root->get_inner_error() != nullptr)
+            {
+                root = root->get_inner_error();
+            }
+
+            if(root->get_creation_time() == untimed)
+            {
+                return;
+            }
+
+            const auto& code = root->get_code();
+            if(const auto entry = find_or_insert(code.get_id(), code.get_name()))
+            {
+                const auto age = static_cast<uint64_t>(std::max<int64_t>(now() - root->get_creation_time(), 0));
+                (handled ? entry->handled : entry->dropped).record(age);
+            }
+        }
+    }
+
+    // nullptr if nothing was recorded for the code yet
+    [[nodiscard]] inline const code_latency* find(uint64_t code)
+    {
+        for(const auto& slot : detail::get_table().entries)
+        {
+            const auto entry = slot.load(std::memory_order_acquire);
+            if(entry && entry->code == code)
+            {
+                return entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    template<class F>
+    void for_each(F&& f)
+    {
+        for(const auto& slot : detail::get_table().entries)
+        {
+            if(const auto entry = slot.load(std::memory_order_acquire))
+            {
+                f(*entry);
+            }
+        }
+    }
+
+    // one line per code and disposition, latencies in microseconds
+    inline void write_summary(std::ostream& os)
+    {
+        os << fmt::format("{:<32} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+                          "code", "", "count", "p50 us", "p90 us", "p99 us", "max us");
+
+        for_each([&](const code_latency& entry)
+        {
+            for(const auto& [disposition, h] : { std::pair<std::string_view, const histogram&> { "handled", entry.handled },
+                                                 std::pair<std::string_view, const histogram&> { "dropped", entry.dropped } })
+            {
+                if(h.count() != 0)
+                {
+                    os << fmt::format("{:<32} {:>8} {:>10} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+                                      entry.name, disposition, h.count(),
+                                      static_cast<double>(h.value_at(0.5)) / 1000.0,
+                                      static_cast<double>(h.value_at(0.9)) / 1000.0,
+                                      static_cast<double>(h.value_at(0.99)) / 1000.0,
+                                      static_cast<double>(h.max()) / 1000.0);
+                }
+            }
+        });
+    }
+}
+
+#define ERR_LATENCY_RECORD_IF(cond, e, handled) \
+    do \
+    { \
+        if(ERR_UNLIKELY(cond)) \
+        { \
+            error_latency::detail::record(e, handled); \
+        } \
+    } while(false)
+
+#else
+
+#define ERR_LATENCY_RECORD_IF(cond, e, handled) do {} while(false)
+
+#endif // ERR_LATENCY
+
+#define ERR_LATENCY_RECORD(e, handled) ERR_LATENCY_RECORD_IF(true, e, handled)
+
+#endif //ERRORHANDLING_LATENCY_H
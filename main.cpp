@@ -8,10 +8,27 @@
 #include <regex>
 
 #define ASSERTIONS_TERMINATE
+#define ERR_TRACING
+#define ERR_LATENCY
 
 #include "result.h"
 #include "formatting.h"
 #include "macros.h"
+#include "async_sink.h"
+#include "error_log.h"
+#include "match.h"
+#include "ranges.h"
+#include "registry.h"
+#include "result_cache.h"
+#include "retry.h"
+#include "system_errors.h"
+
+#include <array>
+#include <charconv>
+#include <list>
+#include <sstream>
+
+#include <thread>
 
 namespace errors
 {
@@ -20,8 +37,18 @@ namespace errors
     DEFINE_ERROR_CODE(2, general_error_category, invalid_pointer_error, "Null pointer make_failure");
     DEFINE_ERROR_CODE(3, general_error_category, argument_out_of_range_error, "Argument out of range");
     DEFINE_ERROR_CODE(4, general_error_category, not_implemented_error, "Function not implemented");
+
+    DEFINE_ERROR_CATEGORY(4, network_error_category, retry_trait::transient);
+    DEFINE_ERROR_CODE(1, network_error_category, connection_reset, "Connection reset");
+    DEFINE_ERROR_CODE(2, network_error_category, too_many_requests, "Too many requests", retry_trait::throttled);
+    DEFINE_ERROR_CODE(3, network_error_category, host_not_found, "Host not found", retry_trait::permanent);
 }
 
+static_assert(errors::connection_reset{}.get_retry_trait() == retry_trait::transient);
+static_assert(errors::too_many_requests{}.get_retry_trait() == retry_trait::throttled);
+static_assert(errors::host_not_found{}.get_retry_trait() == retry_trait::permanent);
+static_assert(errors::unknown_error{}.get_retry_trait() == retry_trait::permanent);
+
 struct LogErrorOnDestruction
 {
     void operator()(const auto &r) const noexcept
@@ -72,6 +99,83 @@ TEST_CASE( "Basic properties of result<int>" )
     REQUIRE( !failed_int_result().is_ok() );
 }
 
+struct non_movable
+{
+    non_movable(int i, std::string s) : i(i), s(std::move(s)) {}
+    non_movable(non_movable&&) = delete;
+
+    int i;
+    std::string s;
+};
+
+struct move_counter
+{
+    move_counter() = default;
+    move_counter(move_counter&& other) noexcept : moves(other.moves + 1) {}
+
+    int moves = 0;
+};
+
+TEST_CASE( "In-place construction of result<T>" )
+{
+    const auto r = []() -> result<non_movable> { return ok_in_place<non_movable>(1, "in place"); }();
+    REQUIRE( r.is_ok() );
+    REQUIRE( r.get_value().i == 1 );
+    REQUIRE( r.get_value().s == "in place" );
+
+    REQUIRE( []() -> result<move_counter> { return ok_in_place<move_counter>(); }().get_value().moves == 0 );
+}
+
+TEST_CASE( "In-place construction of errors" )
+{
+    mresult<> r = err_in_place(errors::unknown_error{}, "in place", ERROR_SITE(errors::unknown_error{}));
+    REQUIRE( r.has_failed() );
+    REQUIRE( r.get_error() == errors::unknown_error{} );
+    REQUIRE( r.get_error().get_explanation() == "in place" );
+    r.dismiss();
+
+    const auto r2 = []() -> result<int> { return err_in_place(errors::unknown_error{}, ERROR_SITE(errors::unknown_error{})); }();
+    REQUIRE( r2.has_failed() );
+    REQUIRE( r2.get_error() == errors::unknown_error{} );
+}
+
+TEST_CASE( "result<T&> refers to existing objects" )
+{
+    std::vector<std::string> cache { "a", "b" };
+
+    const auto lookup = [&](std::size_t i) -> mresult<const std::string&>
+    {
+        if(i >= cache.size())
+        {
+            return err(errors::argument_out_of_range_error{}, "cache miss");
+        }
+
+        return ok(std::cref(cache[i]));
+    };
+
+    REQUIRE( lookup(1).is_ok() );
+    REQUIRE( &lookup(1).get_value() == &cache[1] );
+    REQUIRE( fmt::format("{}", lookup(0)) == "ok" );
+
+    const auto r = lookup(2);
+    REQUIRE( r.has_failed() );
+    REQUIRE( r.get_error() == errors::argument_out_of_range_error{} );
+    REQUIRE( fmt::format("{}", r).find("cache miss") != std::string::npos );
+
+    const auto try_lookup = [&](std::size_t i) -> result<std::size_t>
+    {
+        TRY_ASSIGN(const auto& s, lookup(i));
+        REQUIRE( &s == &cache[i] );
+        return ok(s.size());
+    };
+
+    REQUIRE( try_lookup(0).get_value() == 1 );
+    REQUIRE( try_lookup(3).has_failed() );
+
+    REQUIRE( &lookup(0).map_value([](const std::string& s) -> const char& { return s[0]; }).get_value() == cache[0].data() );
+    REQUIRE( lookup(0).map_value([](const std::string& s) { return s + "!"; }).get_value() == "a!" );
+}
+
 TEST_CASE( "Error handling macros" )
 {
     REQUIRE( []() -> mresult<>
@@ -102,6 +206,28 @@ TEST_CASE( "Error handling macros" )
              }().has_failed() );
 }
 
+TEST_CASE( "Expression-position TRYX" )
+{
+    const auto add = [](int a, int b) { return a + b; };
+
+    REQUIRE( [&]() -> mresult<int> { return ok(add(TRYX(ok_int_result()), TRYX(ok_int_result()))); }().get_value() == 2 );
+
+    auto r = [&]() -> mresult<int> { return ok(add(TRYX(ok_int_result()), TRYX(failed_int_result()))); }();
+    REQUIRE( r.has_failed() );
+    REQUIRE( r.get_error() == basic_errors::propagated_error{} );
+    REQUIRE( *r.get_error().get_inner_error() == errors::unknown_error{} );
+
+    // the value is a member of the result, it is moved out once. TRY_ASSIGN costs the same single move
+    const auto take = [](move_counter value) { return value.moves; };
+    REQUIRE( []() -> result<int> { return ok(TRYX(result<move_counter>(ok_in_place<move_counter>())).moves); }().get_value() == 1 );
+    REQUIRE( [&]() -> result<int> { return ok(take(TRYX(result<move_counter>(ok_in_place<move_counter>())))); }().get_value() == 1 );
+    REQUIRE( []() -> result<int> { const auto v = TRYX(result<move_counter>(ok_in_place<move_counter>())); return ok(v.moves); }().get_value() == 1 );
+    REQUIRE( []() -> result<int> { TRY_ASSIGN(const auto v, result<move_counter>(ok_in_place<move_counter>())); return ok(v.moves); }().get_value() == 1 );
+
+    int i = 1;
+    REQUIRE( [&]() -> result<> { int& ref = TRYX(result<int&>(ok(std::ref(i)))); REQUIRE( &ref == &i ); return ok(); }().is_ok() );
+}
+
 TEST_CASE( "Error message format" )
 {
     mresult<> r = err(errors::unknown_error{}, "UNIT TEST");
@@ -217,7 +343,7 @@ TEST_CASE( "Assertions" )
 
 TEST_CASE( "Valid error data" )
 {
-    error e{errors::unknown_error{}, {__FILE__, __LINE__} };
+    error e{errors::unknown_error{}, ERROR_SITE(errors::unknown_error{}) };
 
     e.set_data(std::string("test"));
 
@@ -226,7 +352,7 @@ TEST_CASE( "Valid error data" )
 
 TEST_CASE( "Invalid error data" )
 {
-    error e{errors::unknown_error{}, {__FILE__, __LINE__} };
+    error e{errors::unknown_error{}, ERROR_SITE(errors::unknown_error{}) };
 
     e.set_data(1);
 
@@ -250,6 +376,1212 @@ TEST_CASE( "Propagate failed result data" )
     REQUIRE(r.get_error().get_inner_error()->get_data<int>() == 1);
 }
 
+struct counting_resource
+    : std::pmr::memory_resource
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+TEST_CASE( "Failure path memory is allocated from the scoped resource" )
+{
+    const auto fail_with_data = []() -> result<>
+    {
+        return err(errors::unknown_error{}, "an explanation which is too long for the small string buffer", std::string("data"));
+    };
+
+    counting_resource upstream;
+
+    {
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        failure_memory_scope scope(&arena);
+
+        auto r = [&]() -> result<> { TRY(fail_with_data()); return ok(); }();
+        REQUIRE( r.has_failed() );
+        REQUIRE( r.get_error().get_inner_error()->get_data<std::string>() == "data" );
+        REQUIRE( upstream.allocations > 0 );
+    }
+
+    REQUIRE( upstream.allocations == upstream.deallocations );
+
+    const auto allocations = upstream.allocations;
+    REQUIRE( fail_with_data().has_failed() );
+    REQUIRE( upstream.allocations == allocations );
+}
+
+namespace static_errors
+{
+    result<int> lookup(int key)
+    {
+        if(key < 0)
+        {
+            return static_err(errors::argument_out_of_range_error{}, "negative key");
+        }
+        return ok(key);
+    }
+}
+
+TEST_CASE( "Static errors are created once and never freed" )
+{
+    std::ignore = static_errors::lookup(-1);
+
+    counting_resource upstream;
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    failure_memory_scope scope(&arena);
+
+    const auto first = static_errors::lookup(-1);
+    const auto second = static_errors::lookup(-2);
+    REQUIRE( first.get_error() == errors::argument_out_of_range_error{} );
+    REQUIRE( first.get_error().get_explanation() == "negative key" );
+    REQUIRE( &first.get_error() == &second.get_error() );
+    REQUIRE( upstream.allocations == 0 );
+
+    // attaching a cause copies the static error
+    const auto handled = static_errors::lookup(-1).handle_error([](const error&) -> result<int>
+    {
+        return static_err(errors::unknown_error{}, "lookup failed");
+    });
+    REQUIRE( handled.get_error() == errors::unknown_error{} );
+    REQUIRE( handled.get_error().get_inner_error() == &first.get_error() );
+    REQUIRE( static_errors::lookup(-1).handle_error([](const error&) -> result<int> { return static_err(errors::unknown_error{}, "lookup failed"); })
+                 .get_error().get_inner_error() == &first.get_error() );
+
+    const auto propagated = []() -> result<int> { TRY_ASSIGN(const auto v, static_errors::lookup(-1)); return ok(v); }();
+    REQUIRE( propagated.get_error().get_inner_error() == &first.get_error() );
+    REQUIRE( first.get_error().get_inner_error() == nullptr );
+
+    // moving the error out copies it, the static error stays as it is
+    const error moved = static_errors::lookup(-1).get_error();
+    REQUIRE( moved == errors::argument_out_of_range_error{} );
+    REQUIRE( &moved != &first.get_error() );
+    REQUIRE( first.get_error().get_explanation() == "negative key" );
+}
+
+TEST_CASE( "Copying a failed result shares the error chain" )
+{
+    const auto fail_with_data = []() -> result<> { return err(errors::unknown_error{}, "upstream failure", 42); };
+    const result<> upstream = [&]() -> result<>
+    {
+        TRY(fail_with_data());
+        return ok();
+    }();
+
+    std::vector<result<>> waiters(8, upstream);
+    for(const auto& r : waiters)
+    {
+        REQUIRE( r.has_failed() );
+        REQUIRE( &r.get_error() == &upstream.get_error() );
+        REQUIRE( r.get_error().get_inner_error()->get_data<int>() == 42 );
+        REQUIRE( fmt::format("{}", r) == fmt::format("{}", upstream) );
+    }
+
+    const auto propagated = [](result<> r) -> result<> { TRY(std::move(r)); return ok(); }(waiters[0]);
+    REQUIRE( propagated.get_error().get_inner_error() == &upstream.get_error() );
+
+    const auto handled = waiters[1].handle_error([&](const auto&) -> result<> { return waiters[2]; });
+    REQUIRE( handled.has_failed() );
+    REQUIRE( &handled.get_error() != &upstream.get_error() );
+    REQUIRE( handled.get_error().get_inner_error() == &upstream.get_error() );
+    REQUIRE( upstream.get_error().get_inner_error()->get_inner_error() == nullptr );
+
+    // moving the error out of a copy leaves the others untouched
+    const error moved = std::move(waiters[3]).get_error();
+    REQUIRE( moved == upstream.get_error() );
+    REQUIRE( moved.get_inner_error() == upstream.get_error().get_inner_error() );
+    REQUIRE( upstream.get_error().get_inner_error()->get_data<int>() == 42 );
+    REQUIRE( &waiters[4].get_error() == &upstream.get_error() );
+
+    const result<int> value = ok(1);
+    const auto value_copy = value;
+    REQUIRE( value_copy.get_value() == 1 );
+}
+
+TEST_CASE( "result_cache memoizes successes and failures" )
+{
+    int loads = 0;
+    const auto loader = [&](const int& key) -> result<std::string>
+    {
+        ++loads;
+        if(key < 0)
+        {
+            return err(errors::argument_out_of_range_error{}, "negative key");
+        }
+
+        return ok(std::to_string(key));
+    };
+
+    result_cache<int, std::string> cache({ .capacity = 16, .shards = 2 });
+
+    const auto hit = cache.get_or_load(1, loader);
+    REQUIRE( hit->get_value() == "1" );
+    REQUIRE( cache.get_or_load(1, loader) == hit );
+    REQUIRE( cache.find(1) == hit );
+    REQUIRE( loads == 1 );
+
+    const auto failed = cache.get_or_load(-1, loader);
+    REQUIRE( failed->has_failed() );
+    REQUIRE( &cache.get_or_load(-1, loader)->get_error() == &failed->get_error() );
+    REQUIRE( loads == 2 );
+
+    cache.erase(1);
+    REQUIRE( cache.find(1) == nullptr );
+    REQUIRE( cache.get_or_load(1, loader)->get_value() == "1" );
+    REQUIRE( loads == 3 );
+}
+
+TEST_CASE( "result_cache uses separate TTLs for failures" )
+{
+    int loads = 0;
+    const auto loader = [&](const int& key) -> result<int>
+    {
+        ++loads;
+        if(key < 0)
+        {
+            return err(errors::argument_out_of_range_error{}, "negative key");
+        }
+
+        return ok(key);
+    };
+
+    result_cache<int, int> cache({ .ok_ttl = std::chrono::hours(1), .failure_ttl = std::chrono::seconds(0) });
+
+    (void)cache.get_or_load(1, loader);
+    (void)cache.get_or_load(1, loader);
+    REQUIRE( loads == 1 );
+
+    (void)cache.get_or_load(-1, loader);
+    (void)cache.get_or_load(-1, loader);
+    REQUIRE( loads == 3 );
+
+    // expired entries are dropped when they are looked up
+    REQUIRE( cache.size() == 2 );
+    REQUIRE( cache.find(-1) == nullptr );
+    REQUIRE( cache.size() == 1 );
+}
+
+TEST_CASE( "result_cache evicts with CLOCK" )
+{
+    result_cache<int, int> cache({ .capacity = 2, .shards = 1 });
+    const auto loader = [](const int& key) -> result<int> { return ok(key); };
+
+    (void)cache.get_or_load(1, loader);
+    (void)cache.get_or_load(2, loader);
+    (void)cache.find(1);
+    (void)cache.get_or_load(3, loader);
+
+    REQUIRE( cache.size() == 2 );
+    REQUIRE( cache.find(1) != nullptr );
+    REQUIRE( cache.find(2) == nullptr );
+    REQUIRE( cache.find(3) != nullptr );
+
+    // released slots are reused before anything is evicted
+    cache.clear();
+    (void)cache.get_or_load(4, loader);
+    (void)cache.get_or_load(5, loader);
+    cache.erase(5);
+    (void)cache.get_or_load(6, loader);
+    REQUIRE( cache.size() == 2 );
+    REQUIRE( cache.find(4) != nullptr );
+    REQUIRE( cache.find(6) != nullptr );
+}
+
+TEST_CASE( "result_cache deduplicates concurrent loads" )
+{
+    result_cache<int, int> cache;
+    std::atomic<int> loads = 0;
+
+    const auto loader = [&](const int& key) -> result<int>
+    {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return ok(key);
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<result_cache<int, int>::handle> handles(8);
+    for(std::size_t i = 0; i < handles.size(); ++i)
+    {
+        threads.emplace_back([&, i]() { handles[i] = cache.get_or_load(7, loader); });
+    }
+
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+
+    REQUIRE( loads == 1 );
+    for(const auto& h : handles)
+    {
+        REQUIRE( h == handles[0] );
+    }
+}
+
+TEST_CASE( "retry retries transient errors" )
+{
+    using namespace errors;
+
+    retry_policy policy;
+    policy.max_attempts = 5;
+    policy.sleep = [](std::chrono::nanoseconds) {};
+
+    int calls = 0;
+    const auto r = retry([&]() -> result<int>
+    {
+        if(++calls < 3)
+        {
+            return err(connection_reset{}, "reset by peer");
+        }
+        return ok(calls);
+    }, policy);
+
+    REQUIRE( r.is_ok() );
+    REQUIRE( r.get_value() == 3 );
+
+    // small errors decide by the retry trait of their code as well
+    calls = 0;
+    const auto small = retry([&]() -> sys::result<int>
+    {
+        ++calls;
+        return err(system_errors::errno_code { calls < 3 ? EAGAIN : EACCES });
+    }, policy);
+
+    REQUIRE( calls == 3 );
+    REQUIRE( small.get_error() == system_errors::errno_code { EACCES } );
+}
+
+TEST_CASE( "retry does not retry permanent errors" )
+{
+    using namespace errors;
+
+    retry_policy policy;
+    policy.sleep = [](std::chrono::nanoseconds) {};
+
+    int calls = 0;
+    const auto r = retry([&]() -> result<>
+    {
+        ++calls;
+        return err(host_not_found{}, "no such host");
+    }, policy);
+
+    REQUIRE( calls == 1 );
+    REQUIRE( r.get_error() == host_not_found{} );
+    REQUIRE( r.get_error().get_inner_error() == nullptr );
+}
+
+TEST_CASE( "retry attaches all attempts when it gives up" )
+{
+    using namespace errors;
+
+    static std::chrono::nanoseconds slept {};
+    retry_policy policy;
+    policy.max_attempts = 3;
+    policy.jitter = 0.0;
+    policy.sleep = [](std::chrono::nanoseconds delay) { slept += delay; };
+
+    int calls = 0;
+    const auto r = retry([&]() -> result<>
+    {
+        ++calls;
+        return err(too_many_requests{}, "slow down");
+    }, policy);
+
+    REQUIRE( calls == 3 );
+    REQUIRE( slept == policy.initial_backoff * policy.throttled_multiplier * 3 );
+
+    const auto& e = r.get_error();
+    REQUIRE( e == basic_errors::retries_exhausted{} );
+    REQUIRE( e.get_explanation() == "gave up after 3 attempts" );
+    REQUIRE( *e.get_inner_error() == too_many_requests{} );
+    REQUIRE( e.get_data<retry_history>().attempts.size() == 2 );
+    REQUIRE( *e.get_data<retry_history>().attempts[0] == too_many_requests{} );
+}
+
+TEST_CASE( "retry respects the shared retry budget" )
+{
+    using namespace errors;
+
+    retry_budget budget(0.5, 1.0);
+    retry_policy policy;
+    policy.max_attempts = 10;
+    policy.budget = &budget;
+    policy.sleep = [](std::chrono::nanoseconds) {};
+
+    int calls = 0;
+    const auto failing = [&]() -> result<>
+    {
+        ++calls;
+        return err(connection_reset{}, "reset by peer");
+    };
+
+    REQUIRE( retry(failing, policy).has_failed() );
+    REQUIRE( calls == 2 );
+
+    REQUIRE( retry([]() -> result<> { return ok(); }, policy).is_ok() );
+    REQUIRE( retry([]() -> result<> { return ok(); }, policy).is_ok() );
+    REQUIRE( budget.get_tokens() == 1.0 );
+}
+
+TEST_CASE( "Tracing records the lifecycle of an error" )
+{
+    using namespace errors;
+
+    const auto run = []()
+    {
+        const auto r = []() -> result<>
+        {
+            TRY([]() -> result<> { return err(unknown_error{}, "traced"); }());
+            return ok();
+        }().handle_error([](const auto&) -> result<> { return err(not_implemented_error{}, "unhandled"); });
+    };
+
+    run();
+    std::size_t events = 0;
+    error_tracing::drain([&](const auto&) { ++events; });
+    REQUIRE( events == 0 );
+
+    error_tracing::enable();
+    run();
+    error_tracing::disable();
+
+    std::vector<std::pair<trace_event_kind, std::string_view>> recorded;
+    error_tracing::drain([&](const error_tracing::event& e) { recorded.emplace_back(e.kind, e.name); });
+
+    const std::vector<std::pair<trace_event_kind, std::string_view>> expected
+    {
+        { trace_event_kind::create, "unknown_error" },
+        { trace_event_kind::propagate, "unknown_error" },
+        { trace_event_kind::handle, "propagated_error" },
+        { trace_event_kind::create, "not_implemented_error" },
+        { trace_event_kind::drop, "not_implemented_error" }
+    };
+    REQUIRE( recorded == expected );
+
+    error_tracing::enable();
+    run();
+    error_tracing::disable();
+
+    std::stringstream json;
+    error_tracing::write_chrome_trace(json);
+    REQUIRE( json.str().starts_with("{\"traceEvents\":[") );
+    REQUIRE( json.str().find(R"("name":"unknown_error","cat":"propagate","ph":"i")") != std::string::npos );
+    REQUIRE( error_tracing::dropped_events() == 0 );
+
+    // large values keep the error inline (sbo_storage), the result left behind by a move drops nothing
+    error_tracing::enable();
+    {
+        result<std::array<char, 512>> failed = err(unknown_error{}, "large value");
+        const auto moved = std::move(failed);
+        REQUIRE( moved.has_failed() );
+        REQUIRE( !failed.has_failed() ); // NOLINT(bugprone-use-after-move)
+    }
+    error_tracing::disable();
+
+    std::size_t creates = 0;
+    std::size_t drops = 0;
+    error_tracing::drain([&](const error_tracing::event& e)
+    {
+        creates += e.kind == trace_event_kind::create;
+        drops += e.kind == trace_event_kind::drop;
+    });
+    REQUIRE( creates == 1 );
+    REQUIRE( drops == 1 );
+
+    // the buffer of an exited thread is released once it is drained
+    const auto buffers = []()
+    {
+        auto& r = error_tracing::detail::get_registry();
+        std::scoped_lock lock(r.mutex);
+        return r.buffers.size();
+    };
+    const auto before = buffers();
+
+    error_tracing::enable();
+    std::thread(run).join();
+    error_tracing::disable();
+    REQUIRE( buffers() == before + 1 );
+
+    events = 0;
+    error_tracing::drain([&](const auto&) { ++events; });
+    REQUIRE( events == expected.size() );
+    REQUIRE( buffers() == before );
+}
+
+TEST_CASE( "Time to handle is recorded per root cause" )
+{
+    using namespace errors;
+
+    const auto handled_before = [](uint64_t code, bool handled) -> uint64_t
+    {
+        const auto entry = error_latency::find(code);
+        return entry ? (handled ? entry->handled : entry->dropped).count() : 0;
+    };
+
+    const auto handled = handled_before(argument_out_of_range_error{}, true);
+    const auto dropped = handled_before(argument_out_of_range_error{}, false);
+
+    {
+        const auto r = []() -> result<>
+        {
+            TRY([]() -> result<> { return err(argument_out_of_range_error{}, "measured"); }());
+            return ok();
+        }().handle_error([](const auto&) -> result<> { return ok(); });
+    }
+
+    REQUIRE( handled_before(argument_out_of_range_error{}, true) == handled + 1 );
+    REQUIRE( handled_before(argument_out_of_range_error{}, false) == dropped );
+
+    {
+        const result<> r = err(argument_out_of_range_error{}, "dropped");
+    }
+
+    REQUIRE( handled_before(argument_out_of_range_error{}, false) == dropped + 1 );
+
+    // static errors are created once, they have no age
+    {
+        const auto r = static_errors::lookup(-1);
+    }
+    REQUIRE( handled_before(argument_out_of_range_error{}, false) == dropped + 1 );
+
+    // moving a failed result with a large value does not record the result left behind
+    {
+        result<std::array<char, 512>> failed = err(argument_out_of_range_error{}, "large value");
+        auto moved = std::move(failed);
+        const auto again = std::move(moved);
+    }
+    REQUIRE( handled_before(argument_out_of_range_error{}, false) == dropped + 2 );
+
+    std::stringstream summary;
+    error_latency::write_summary(summary);
+    REQUIRE( summary.str().find("argument_out_of_range_error") != std::string::npos );
+}
+
+TEST_CASE( "Latency histograms report quantiles within the bucket precision" )
+{
+    error_latency::histogram h;
+    for(uint64_t v = 1; v <= 1000; ++v)
+    {
+        h.record(v * 1000);
+    }
+
+    REQUIRE( h.count() == 1000 );
+    REQUIRE( h.max() == 1'000'000 );
+    REQUIRE( h.value_at(0.5) >= 500'000 );
+    REQUIRE( h.value_at(0.5) <= 500'000 * 17 / 16 );
+    REQUIRE( h.value_at(0.99) >= 990'000 );
+    REQUIRE( h.value_at(1.0) == 1'000'000 );
+}
+
+namespace compile_time
+{
+    using namespace errors;
+
+    constexpr result<int, error_code> parse_digit(char c)
+    {
+        if(c < '0' || c > '9')
+        {
+            return err(argument_out_of_range_error{});
+        }
+
+        return ok(c - '0');
+    }
+
+    constexpr result<int, error_code> parse_number(std::string_view text)
+    {
+        if(text.empty())
+        {
+            return err(invalid_pointer_error{});
+        }
+
+        int value = 0;
+        for(const auto c : text)
+        {
+            TRY_ASSIGN(const auto digit, parse_digit(c));
+            value = value * 10 + digit;
+        }
+
+        return ok(value);
+    }
+
+    // TRYX can not be used here, compilers do not evaluate statement expressions that return
+    constexpr result<int, error_code> sum(std::string_view a, std::string_view b)
+    {
+        TRY_ASSIGN(const auto x, parse_number(a));
+        TRY_ASSIGN(const auto y, parse_number(b));
+        return ok(x + y);
+    }
+
+    constexpr result<void, error_code> validate(std::initializer_list<std::string_view> table)
+    {
+        for(const auto entry : table)
+        {
+            TRY(parse_number(entry));
+        }
+
+        return ok();
+    }
+
+    static_assert(parse_number("1234").get_value() == 1234);
+    static_assert(parse_number("12x4").get_error() == argument_out_of_range_error{});
+    static_assert(parse_number("").get_error() == invalid_pointer_error{});
+    static_assert(sum("40", "2").get_value() == 42);
+    static_assert(sum("40", "-2").has_failed());
+    static_assert(parse_number("21").map_value([](int v) { return v * 2; }).get_value() == 42);
+    static_assert(validate({ "1", "22", "333" }).is_ok());
+    static_assert(validate({ "1", "2b", "333" }).get_error() == argument_out_of_range_error{});
+
+    // a compile-time built lookup table that reports which entry is invalid
+    template<std::size_t N>
+    constexpr result<std::array<int, N>, error_code> build_table(const std::array<std::string_view, N>& entries)
+    {
+        std::array<int, N> table {};
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            TRY_ASSIGN(table[i], parse_number(entries[i]));
+        }
+
+        return ok(table);
+    }
+
+    constexpr auto table = build_table<3>({ "7", "11", "13" });
+    static_assert(table.is_ok() && table.get_value()[2] == 13);
+}
+
+TEST_CASE( "constexpr results behave the same at runtime" )
+{
+    using namespace compile_time;
+
+    std::string text = "12a";
+    const auto r = parse_number(text);
+    REQUIRE( r.get_error() == errors::argument_out_of_range_error{} );
+    REQUIRE( sum("1", "2").get_value() == 3 );
+    static_assert(sizeof(result<int, error_code>) <= sizeof(error_code) + 2 * sizeof(std::size_t));
+}
+
+namespace two_tier
+{
+    DEFINE_ERROR_CATEGORY(5, decode_error_category);
+    DEFINE_ERROR_CODE(1, decode_error_category, truncated_input_error, "Input ended in the middle of a field");
+    DEFINE_ERROR_CODE(2, decode_error_category, invalid_digit_error, "Not a decimal digit");
+
+    // the small error of the inner loop, one byte
+    enum class decode_error : uint8_t
+    {
+        truncated,
+        invalid_digit
+    };
+
+    constexpr error_code to_error_code(decode_error e)
+    {
+        switch(e)
+        {
+            case decode_error::truncated:       return truncated_input_error{};
+            case decode_error::invalid_digit:   return invalid_digit_error{};
+        }
+        return truncated_input_error{};
+    }
+
+    constexpr result<int, decode_error> decode_digit(char c)
+    {
+        if(c < '0' || c > '9')
+        {
+            return err(decode_error::invalid_digit);
+        }
+
+        return ok(c - '0');
+    }
+
+    constexpr result<int, decode_error> decode_field(std::string_view text)
+    {
+        if(text.empty())
+        {
+            return err(decode_error::truncated);
+        }
+
+        int value = 0;
+        for(const auto c : text)
+        {
+            TRY_ASSIGN(const auto digit, decode_digit(c));
+            value = value * 10 + digit;
+        }
+
+        return ok(value);
+    }
+
+    // the layer boundary, failures of decode_field are escalated to an error here
+    result<int> parse_record(std::string_view text)
+    {
+        TRY_ASSIGN(const auto value, decode_field(text));
+        return ok(value);
+    }
+
+    static_assert(sizeof(result<int, decode_error>) <= 2 * sizeof(int));
+    static_assert(decode_field("123").get_value() == 123);
+    static_assert(decode_field("1x3").get_error() == decode_error::invalid_digit);
+}
+
+TEST_CASE( "Small errors stay inline and are escalated at the boundary" )
+{
+    using namespace two_tier;
+
+    std::string text = "12x";
+    REQUIRE( decode_field(text).get_error() == decode_error::invalid_digit );
+
+    const auto r = parse_record(text);
+    REQUIRE( r.has_failed() );
+    REQUIRE( r.get_error() == invalid_digit_error{} );
+    REQUIRE( std::string_view(r.get_error().get_site().expression) == "decode_field(text)" );
+    REQUIRE( r.get_error().get_site().function.find("parse_record") != std::string_view::npos );
+    REQUIRE( r.get_error().get_inner_error() == nullptr );
+    REQUIRE( parse_record("42").get_value() == 42 );
+
+    const auto formatted = fmt::format("{}", decode_field(""));
+    REQUIRE( formatted.find("'truncated_input_error'") != std::string::npos );
+    REQUIRE( formatted.find("decode_error_category") != std::string::npos );
+
+    const auto handled = decode_field("").handle_error([](decode_error e) -> result<int, decode_error>
+    {
+        if(e == decode_error::truncated)
+        {
+            return ok(0);
+        }
+        return err(e);
+    });
+    REQUIRE( handled.get_value() == 0 );
+
+    const auto unhandled = decode_field("x").handle_error([](decode_error) -> result<int, decode_error>
+    {
+        return err(decode_error::truncated);
+    });
+    REQUIRE( unhandled.get_error() == decode_error::truncated );
+}
+
+#if ERR_POSIX_SYSCALLS
+namespace system_io
+{
+    // the I/O layer boundary
+    result<std::size_t> read_some(int fd, char* buffer, std::size_t size)
+    {
+        TRY_ASSIGN(const auto count, sys::restart_on_eintr([&]() { return sys::read(fd, buffer, size); }));
+        return ok(count);
+    }
+}
+#endif // ERR_POSIX_SYSCALLS
+
+TEST_CASE( "Syscall errors are inline errno values with constexpr codes" )
+{
+    static_assert(detail::is_inline_error_v<system_errors::errno_code>);
+    static_assert(sizeof(sys::result<std::size_t>) <= 2 * sizeof(std::size_t));
+    static_assert(system_errors::code(EAGAIN).get_name() == "EAGAIN");
+    static_assert(system_errors::code(EAGAIN).get_retry_trait() == retry_trait::transient);
+    static_assert(system_errors::code(EBADF).get_retry_trait() == retry_trait::permanent);
+    static_assert(system_errors::code(EINTR).get_category() == system_errors::system_category{});
+    static_assert(system_errors::code(EPIPE) != system_errors::code(EIO));
+    static_assert(system_errors::code(100000).get_name() == "unknown_errno");
+
+    errno = ENOENT;
+    REQUIRE( sys::check(-1).get_error() == system_errors::errno_code { ENOENT } );
+    REQUIRE( sys::check(3).get_value() == 3 );
+
+#if ERR_POSIX_SYSCALLS
+    const auto [read_end, write_end] = sys::pipe().get_value();
+    REQUIRE( sys::set_nonblocking(read_end).is_ok() );
+
+    char buffer[8];
+    const auto empty = sys::read(read_end, buffer, sizeof(buffer));
+    REQUIRE( empty.has_failed() );
+    REQUIRE( empty.get_error().would_block() );
+
+    REQUIRE( sys::write(write_end, "abc", 3).get_value() == 3 );
+    REQUIRE( sys::read(read_end, buffer, sizeof(buffer)).get_value() == 3 );
+
+    const auto escalated = system_io::read_some(read_end, buffer, sizeof(buffer));
+    REQUIRE( escalated.get_error() == system_errors::code(EAGAIN) );
+    REQUIRE( escalated.get_error().get_code().get_retry_trait() == retry_trait::transient );
+
+    REQUIRE( sys::close(read_end).is_ok() );
+    REQUIRE( sys::close(write_end).is_ok() );
+    REQUIRE( sys::close(write_end).get_error() == system_errors::errno_code { EBADF } );
+#endif // ERR_POSIX_SYSCALLS
+}
+
+TEST_CASE( "Unchecked accessors return the same as the checked ones" )
+{
+    using namespace errors;
+
+    const result<int> good = ok(42);
+    REQUIRE( good.is_ok() );
+    REQUIRE( good.unchecked_value() == good.get_value() );
+
+    const result<int> bad = err(unknown_error{}, "unchecked");
+    REQUIRE( bad.has_failed() );
+    REQUIRE( &bad.unchecked_error() == &bad.get_error() );
+
+    const result<void, error_code> void_bad = err(unknown_error{});
+    REQUIRE( void_bad.unchecked_error() == unknown_error{} );
+
+    static_assert(compile_time::parse_number("17").unchecked_value() == 17);
+}
+
+TEST_CASE( "Match errors on codes and categories" )
+{
+    using namespace errors;
+
+    const auto classify = [](const error& e)
+    {
+        return match(e,
+                     on<connection_reset>([]() { return std::string("reset"); }),
+                     on<network_error_category>([](const error& e) { return std::string(e.get_code().get_name()); }),
+                     on<invalid_pointer_error>([]() { return std::string("null"); }),
+                     on<not_implemented_error>([]() { return std::string("todo"); }),
+                     otherwise([]() { return std::string("other"); }));
+    };
+
+    REQUIRE( classify(error(connection_reset{}, ERROR_SITE(connection_reset{}))) == "reset" );
+    REQUIRE( classify(error(host_not_found{}, ERROR_SITE(host_not_found{}))) == "host_not_found" );
+    REQUIRE( classify(error(invalid_pointer_error{}, ERROR_SITE(invalid_pointer_error{}))) == "null" );
+    REQUIRE( classify(error(not_implemented_error{}, ERROR_SITE(not_implemented_error{}))) == "todo" );
+    REQUIRE( classify(error(unknown_error{}, ERROR_SITE(unknown_error{}))) == "other" );
+    REQUIRE( classify(error(basic_errors::propagated_error{}, ERROR_SITE(basic_errors::propagated_error{}))) == "other" );
+
+    mresult<> r = err(argument_out_of_range_error{}, "matched in a handler");
+    REQUIRE(r.handle_error([](const error& e) -> result<>
+    {
+        return match(e,
+                     on<argument_out_of_range_error>([]() -> result<> { return ok(); }),
+                     otherwise([](const error& e) -> result<> { return err(e.get_code(), "not handled"); }));
+    }).is_ok());
+
+    // small errors are matched by their error code
+    static_assert(match(two_tier::decode_error::truncated,
+                        on<two_tier::truncated_input_error>([]() { return 1; }),
+                        on<two_tier::decode_error_category>([]() { return 2; }),
+                        otherwise([]() { return 3; })) == 1);
+    static_assert(match(two_tier::decode_error::invalid_digit,
+                        on<two_tier::truncated_input_error>([]() { return 1; }),
+                        on<two_tier::decode_error_category>([]() { return 2; }),
+                        otherwise([]() { return 3; })) == 2);
+}
+
+namespace errors
+{
+    REGISTER_ERROR_CODES(unknown_error, invalid_pointer_error, argument_out_of_range_error, not_implemented_error);
+}
+
+TEST_CASE( "Error codes are found by id in the registry" )
+{
+    using namespace errors;
+
+    const auto code = error_registry::find_code(invalid_pointer_error::id);
+    REQUIRE( code != nullptr );
+    REQUIRE( code->name == "invalid_pointer_error" );
+    REQUIRE( code->category->name == "general_error_category" );
+    REQUIRE( code->get_code() == invalid_pointer_error{} );
+    REQUIRE( error_registry::find_category(general_error_category::id) == code->category );
+    REQUIRE( error_registry::find_code(connection_reset::id) == nullptr );
+
+    // registering again is fine, the same id with another name is not
+    REQUIRE( error_registry::register_code(invalid_pointer_error{}).get_value() == code );
+    const error_code impostor(general_error_category{}, invalid_pointer_error::id, "impostor", "Same id");
+    REQUIRE( error_registry::register_code(impostor).get_error() == error_registry::code_id_collision{} );
+    REQUIRE( error_registry::register_category(error_category(general_error_category::id, "impostor_category"))
+                 .get_error() == error_registry::category_id_collision{} );
+
+    std::size_t load_failures = 0;
+    error_registry::for_each_load_failure([&](const error&) { ++load_failures; });
+    REQUIRE( load_failures == 0 );
+}
+
+TEST_CASE( "Categories allocated at runtime get unique ids" )
+{
+    const auto plugin = error_registry::allocate_category("plugin_errors", retry_trait::transient).get_value();
+    const auto other = error_registry::allocate_category("other_plugin_errors").get_value();
+    REQUIRE( plugin.get_id() != other.get_id() );
+    REQUIRE( static_cast<uint32_t>(plugin.get_id()) >= error_registry::first_dynamic_category_id );
+    REQUIRE( error_registry::allocate_category("plugin_errors").get_value() == plugin );
+
+    // static categories can not take the ids of allocated ones
+    const error_category squatter(static_cast<int32_t>(error_registry::first_dynamic_category_id) + 0x100, "squatter");
+    REQUIRE( error_registry::register_category(squatter).get_error() == error_registry::reserved_category_id{} );
+    REQUIRE( error_registry::find_category(static_cast<uint32_t>(squatter.get_id())) == nullptr );
+    REQUIRE( error_registry::allocate_category("third_plugin_errors").is_ok() );
+
+    std::string name = "plugin_timeout";
+    const auto timeout = error_registry::define_code(plugin, 1, name, "Plugin timed out").get_value();
+    name = "overwritten";
+    REQUIRE( timeout.get_name() == "plugin_timeout" );
+    REQUIRE( timeout.get_retry_trait() == retry_trait::transient );
+    REQUIRE( error_registry::find_code(timeout.get_id())->name == "plugin_timeout" );
+
+    const auto unregistered = error_registry::define_code(error_category(0x7fff'0000, "unregistered"), 1, "code", "");
+    REQUIRE( unregistered.get_error() == error_registry::unknown_category{} );
+}
+
+namespace breadcrumbs
+{
+    int described = 0;
+
+    result<int> check_offset(int offset)
+    {
+        if(offset > 100)
+        {
+            return err(errors::argument_out_of_range_error{}, "offset past the end");
+        }
+        return ok(offset);
+    }
+
+    result<int> read_block(int offset)
+    {
+        error_context::scope ctx([&] { ++described; return fmt::format("offset {}", offset); });
+        TRY_ASSIGN(const auto block, check_offset(offset));
+        return ok(block);
+    }
+
+    result<int> load_shard(int shard, int offset)
+    {
+        error_context::scope ctx([&] { ++described; return fmt::format("shard {}", shard); });
+        TRY_ASSIGN(const auto block, read_block(offset));
+        return ok(block);
+    }
+
+    result<int> handle_request(int id, int offset)
+    {
+        error_context::scope ctx([&] { ++described; return fmt::format("request {}", id); });
+        TRY_ASSIGN(const auto block, load_shard(3, offset));
+        return ok(block);
+    }
+}
+
+TEST_CASE( "Context breadcrumbs are captured only on failure" )
+{
+    breadcrumbs::described = 0;
+    REQUIRE( breadcrumbs::handle_request(7, 10).get_value() == 10 );
+    REQUIRE( breadcrumbs::described == 0 );
+
+    const auto r = breadcrumbs::handle_request(7, 200);
+    REQUIRE( r.has_failed() );
+    REQUIRE( breadcrumbs::described == 3 );
+    REQUIRE( error_context::collect(r.get_error()) == std::vector<std::string_view> { "request 7", "shard 3", "offset 200" } );
+    REQUIRE( error_context::detail::current_stack().top == nullptr );
+
+    const auto message = fmt::format("{}", r);
+    REQUIRE( message.find("in request 7 > shard 3 > offset 200") != std::string::npos );
+
+    // a failure created elsewhere gets the scopes it passes through
+    auto replay = [&](int id) -> result<int>
+    {
+        error_context::scope ctx([&] { return fmt::format("replay {}", id); });
+        TRY_ASSIGN(const auto block, result<int>(r));
+        return ok(block);
+    };
+    REQUIRE( error_context::collect(replay(8).get_error()) ==
+             std::vector<std::string_view> { "request 7", "shard 3", "offset 200", "replay 8" } );
+}
+
+namespace logging
+{
+    std::vector<std::string> lines;
+    int64_t clock = 0;
+
+    template<class V = void>
+    using logged_result = result<V, error, error_log::final_action>;
+
+    logged_result<> fail_here() { return err(errors::connection_reset{}, "peer went away"); }
+    logged_result<> fail_there() { return err(errors::connection_reset{}, "peer went away"); }
+    result<void, system_errors::errno_code, error_log::final_action> fail_inline() { return err(system_errors::errno_code { EAGAIN }); }
+}
+
+TEST_CASE( "Logging final action deduplicates and rate-limits failures" )
+{
+    error_log::configure({ .first_n = 2,
+                           .interval = std::chrono::seconds(1),
+                           .write = [](std::string_view text) { logging::lines.emplace_back(text); },
+                           .now = []() { return logging::clock; } });
+
+    for(int i = 0; i < 5; ++i)
+    {
+        std::ignore = logging::fail_here();
+    }
+    std::ignore = logging::fail_there();
+    REQUIRE( logging::lines.size() == 3 );
+    REQUIRE( logging::lines[0].find("connection_reset") != std::string::npos );
+
+    // the next window starts with the summary of the previous one
+    logging::clock += std::chrono::nanoseconds(std::chrono::seconds(1)).count();
+    std::ignore = logging::fail_here();
+    REQUIRE( logging::lines.size() == 5 );
+    REQUIRE( logging::lines[3].starts_with("suppressed 3 similar errors: 'connection_reset' at ") );
+
+    for(int i = 0; i < 4; ++i)
+    {
+        std::ignore = logging::fail_inline();
+    }
+    REQUIRE( logging::lines.size() == 7 );
+    error_log::flush();
+    REQUIRE( logging::lines.size() == 8 );
+    REQUIRE( logging::lines[7] == "suppressed 2 similar errors: 'EAGAIN'\n" );
+
+    // bursts that stop are summarized by the next failure of another fingerprint
+    for(int i = 0; i < 3; ++i)
+    {
+        std::ignore = logging::fail_inline();
+    }
+    logging::clock += std::chrono::nanoseconds(std::chrono::seconds(1)).count();
+    std::ignore = logging::fail_here();
+    REQUIRE( logging::lines.size() == 10 );
+    REQUIRE( logging::lines[8] == "suppressed 3 similar errors: 'EAGAIN'\n" );
+    REQUIRE( logging::lines[9].find("connection_reset") != std::string::npos );
+
+    error_log::configure({});
+}
+
+TEST_CASE( "Bounded MPSC queue hands values over in order" )
+{
+    error_sink::detail::mpsc_queue<int> queue(3);
+    REQUIRE( queue.capacity() == 4 );
+
+    for(int i = 0; i < 4; ++i)
+    {
+        REQUIRE( queue.try_push(i) );
+    }
+    int value = 42;
+    REQUIRE( !queue.try_push(value) );
+
+    for(int i = 0; i < 4; ++i)
+    {
+        REQUIRE( queue.try_pop(value) );
+        REQUIRE( value == i );
+    }
+    REQUIRE( !queue.try_pop(value) );
+}
+
+namespace async_logging
+{
+    std::mutex mutex;
+    std::string written;
+    std::size_t writes = 0;
+
+    void write(std::string_view text)
+    {
+        std::scoped_lock lock(mutex);
+        written += text;
+        ++writes;
+    }
+
+    template<class V = void>
+    using sink_result = result<V, error, error_sink::final_action>;
+
+    sink_result<int> fail(int i)
+    {
+        return err(errors::argument_out_of_range_error{}, fmt::format("request {}", i));
+    }
+}
+
+TEST_CASE( "Async sink writes dropped errors on its own thread" )
+{
+    error_sink::start({ .capacity = 1024, .batch_size = 16, .overflow = error_sink::overflow_policy::block, .write = async_logging::write });
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t]()
+        {
+            for(int i = 0; i < 100; ++i)
+            {
+                std::ignore = async_logging::fail(t * 100 + i);
+                std::ignore = result<int, system_errors::errno_code, error_sink::final_action>(err(system_errors::errno_code { EINTR }));
+            }
+        });
+    }
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+    error_sink::stop();
+
+    std::size_t count = 0;
+    for(auto pos = async_logging::written.find("argument_out_of_range_error"); pos != std::string::npos;
+        pos = async_logging::written.find("argument_out_of_range_error", pos + 1))
+    {
+        ++count;
+    }
+    REQUIRE( count == 400 );
+    REQUIRE( async_logging::written.find("request 399") != std::string::npos );
+    REQUIRE( async_logging::written.find("'EINTR'") != std::string::npos );
+    REQUIRE( async_logging::writes < 800 );
+    REQUIRE( error_sink::dropped_errors() == 0 );
+
+    // not running, written synchronously
+    async_logging::written.clear();
+    std::ignore = async_logging::fail(1);
+    REQUIRE( async_logging::written.find("request 1") != std::string::npos );
+
+    // no error is lost while the sink stops
+    async_logging::written.clear();
+    error_sink::start({ .capacity = 16, .overflow = error_sink::overflow_policy::block, .write = async_logging::write });
+    threads.clear();
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([]()
+        {
+            for(int i = 0; i < 2000; ++i)
+            {
+                std::ignore = async_logging::fail(i);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    error_sink::stop();
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    count = 0;
+    for(auto pos = async_logging::written.find("argument_out_of_range_error"); pos != std::string::npos;
+        pos = async_logging::written.find("argument_out_of_range_error", pos + 1))
+    {
+        ++count;
+    }
+    REQUIRE( count == 8000 );
+}
+
+namespace pipelines
+{
+    int parsed = 0;
+
+    result<int> parse(std::string_view text)
+    {
+        ++parsed;
+        int value = 0;
+        if(text.empty() || std::from_chars(text.data(), text.data() + text.size(), value).ptr != text.data() + text.size())
+        {
+            return err(errors::argument_out_of_range_error{}, std::string(text));
+        }
+        return ok(value);
+    }
+
+    result<int> positive(int value)
+    {
+        if(value <= 0)
+        {
+            return err(errors::argument_out_of_range_error{}, "not positive");
+        }
+        return ok(value);
+    }
+}
+
+TEST_CASE( "Ranges of results are processed lazily and collected" )
+{
+    const std::vector<std::string_view> good { "1", "2", "3" };
+    auto collected = good | std::views::transform(pipelines::parse)
+                          | result_views::and_then(pipelines::positive)
+                          | result_views::map_value([](int value) { return value * 10; })
+                          | collect_results();
+    REQUIRE( collected.is_ok() );
+    REQUIRE( collected.get_value() == std::vector { 10, 20, 30 } );
+    REQUIRE( collected.get_value().capacity() == 3 );
+
+    // stops at the first failure
+    pipelines::parsed = 0;
+    const std::vector<std::string_view> bad { "1", "x", "-1", "4" };
+    auto failed = collect_results<std::list<int>>(bad | std::views::transform(pipelines::parse) | result_views::and_then(pipelines::positive));
+    REQUIRE( failed.has_failed() );
+    REQUIRE( failed.get_error().get_explanation() == "x" );
+    REQUIRE( pipelines::parsed == 2 );
+
+    // every element is produced once
+    pipelines::parsed = 0;
+    std::vector<int> values;
+    for(auto value : bad | std::views::transform(pipelines::parse) | result_views::ok_values)
+    {
+        values.push_back(value);
+    }
+    REQUIRE( values == std::vector { 1, -1, 4 } );
+    REQUIRE( pipelines::parsed == 4 );
+
+    // failures in a container are shared, the container keeps them
+    std::vector<result<int>> results;
+    for(auto text : bad)
+    {
+        auto parsed = pipelines::parse(text);
+        results.push_back(parsed.is_ok() ? pipelines::positive(parsed.get_value()) : std::move(parsed));
+    }
+    std::vector<std::string> explanations;
+    for(const auto& e : results | result_views::errors)
+    {
+        explanations.emplace_back(e.get_explanation());
+    }
+    REQUIRE( explanations == std::vector<std::string> { "x", "not positive" } );
+    REQUIRE( collect_results(results | result_views::map_value([](int value) { return value; })).has_failed() );
+    REQUIRE( results[1].has_failed() );
+    REQUIRE( std::ranges::distance(results | result_views::ok_values | std::views::take(1)) == 1 );
+
+    // results with large values keep their error inline and can not be copied
+    using large = std::array<char, 512>;
+    std::vector<result<large>> large_results;
+    large_results.emplace_back(ok(large { 'a' }));
+    large_results.emplace_back(err(errors::unknown_error{}, "large value"));
+    auto firsts = collect_results(large_results | result_views::map_value([](const large& value) { return value[0]; }));
+    REQUIRE( firsts.get_error().get_explanation() == "large value" );
+    REQUIRE( large_results[1].get_error().get_explanation() == "large value" );
+    REQUIRE( (large_results | result_views::and_then([](const large& value) -> result<large> { return ok(value); })
+                            | collect_results()).has_failed() );
+    large_results.pop_back();
+    REQUIRE( collect_results(large_results | result_views::map_value([](const large& value) { return value[0]; })).get_value()
+                 == std::vector { 'a' } );
+}
+
+TEST_CASE( "Sites are identified by a hash of their file and line" )
+{
+    const auto& site = ERROR_SITE(errors::unknown_error{});
+    REQUIRE( site.id == detail::site_id(__FILE__, __LINE__ - 1) );
+    REQUIRE( !site.is_stripped() );
+    REQUIRE( fmt::format("{}", site) == fmt::format("{}:{}", __FILE__, site.line) );
+
+    // as printed by builds with ERR_VERBOSITY_LINES, the hash is the one of tools/error_sites.py
+    static_assert(detail::site_id("app.cpp", 11) == 0x8e5187849f9948b9);
+    constexpr error_site stripped { "", 11, "", "", "", detail::site_id("app.cpp", 11) };
+    REQUIRE( stripped.is_stripped() );
+    REQUIRE( fmt::format("{}", stripped) == "site#8e5187849f9948b9:11" );
+    REQUIRE( !detail::unknown_site.is_stripped() );
+}
+
+TEST_CASE( "Assertion handler and data type names are configurable without exceptions and RTTI" )
+{
+    error e { errors::unknown_error{}, detail::unknown_site };
+    e.set_data(1);
+    REQUIRE( e.get_data_type() == "int" );
+    REQUIRE( detail::type_name<errors::unknown_error>() == "errors::unknown_error" );
+
+    // the default handler throws, see no_exceptions.cpp for builds without exceptions
+    const auto previous = set_assertion_handler([](error&& failed) { throw std::runtime_error(std::string(failed.get_code().get_name())); });
+    try
+    {
+        std::ignore = []() -> result<> { EXPECT(false, "handled"); return ok(); }();
+        FAIL_CHECK("handler did not throw");
+    }
+    catch(const std::runtime_error& failed)
+    {
+        REQUIRE( std::string_view(failed.what()) == "precondition_error" );
+    }
+    set_assertion_handler(previous);
+}
+
 TEST_CASE( "Handle error using 'handle_error'")
 {
     using namespace errors;
@@ -6,7 +6,9 @@
 #define ERRORHANDLING_MAKE_RESULT_H
 
 #include "error.h"
-#include "assert.h"
+
+#include <functional>
+#include <tuple>
 
 namespace detail
 {
@@ -28,91 +30,154 @@ namespace detail
         T error;
     };
 
+    // holds references to the constructor arguments only,
+    // must be converted to a result within the same full-expression
+    template<class T, class... Args>
+    struct [[nodiscard]] in_place_success
+    {
+        std::tuple<Args&&...> args;
+    };
+
+    template<class T, class... Args>
+    struct [[nodiscard]] in_place_failure
+    {
+        std::tuple<Args&&...> args;
+    };
+
     template<class Error = error>
-    failure<std::decay_t<Error>> make_failure(Error&& error)
+    constexpr failure<std::decay_t<Error>> make_failure(Error&& error)
     {
         return { .error = std::forward<Error>(error) };
     }
 
     template<class ErrorCode, class Error = class error>
     failure<std::decay_t<Error>> make_failure(ErrorCode&& code,
-                                              std::string explanation,
-                                              source_location src_loc)
+                                              std::string_view explanation,
+                                              const error_site& site)
     {
         return
         {
             .error = Error(std::forward<ErrorCode&&>(code),
-                           std::move(explanation),
-                           src_loc)
+                           explanation,
+                           site)
         };
     }
 
     template<class ErrorCode, class Error = class error>
     failure<std::decay_t<Error>> make_failure(ErrorCode code,
-                                              std::string explanation,
-                                              std::unique_ptr<Error> innerError,
-                                              source_location src_loc)
+                                              std::string_view explanation,
+                                              failure_ptr<Error> innerError,
+                                              const error_site& site)
     {
         return
         {
             .error = Error(std::forward<ErrorCode&&>(code),
-                           std::move(explanation),
+                           explanation,
                            std::move(innerError),
-                           src_loc)
+                           site)
         };
     }
 
     template<class ErrorCode, class T, class Error = class error>
     failure<std::decay_t<Error>> make_failure(ErrorCode code,
-                                              std::string explanation,
+                                              std::string_view explanation,
                                               T&& data,
-                                              source_location src_loc)
+                                              const error_site& site)
     {
         return
         {
             .error = std::move(Error(std::forward<ErrorCode&&>(code),
-                           std::move(explanation),
-                           src_loc).set_data(std::forward<T>(data)))
+                           explanation,
+                           site).set_data(std::forward<T>(data)))
         };
     }
 
     template<class ErrorCode, class T, class Error = class error>
     failure<std::decay_t<Error>> make_failure(ErrorCode code,
-                                              std::string explanation,
-                                              std::unique_ptr<Error> innerError,
+                                              std::string_view explanation,
+                                              failure_ptr<Error> innerError,
                                               T&& data,
-                                              source_location src_loc)
+                                              const error_site& site)
     {
         return
         {
-            .error = Error(std::forward<ErrorCode&&>(code),
-                           std::move(explanation),
+            .error = std::move(Error(std::forward<ErrorCode&&>(code),
+                           explanation,
                            std::move(innerError),
-                           src_loc).set_data(std::forward<T>(data))
-
+                           site).set_data(std::forward<T>(data)))
         };
     }
 
+    // the error only points to its site, see error
+    template<class ErrorCode, class Error = class error>
+    failure<std::decay_t<Error>> make_failure(ErrorCode&&, std::string_view, error_site&&) = delete;
+    template<class ErrorCode, class Error = class error>
+    failure<std::decay_t<Error>> make_failure(ErrorCode, std::string_view, failure_ptr<Error>, error_site&&) = delete;
+    template<class ErrorCode, class T, class Error = class error>
+    failure<std::decay_t<Error>> make_failure(ErrorCode, std::string_view, T&&, error_site&&) = delete;
+    template<class ErrorCode, class T, class Error = class error>
+    failure<std::decay_t<Error>> make_failure(ErrorCode, std::string_view, failure_ptr<Error>, T&&, error_site&&) = delete;
+
+    // the immortal node of a static error, see static_err
+    template<class ErrorCode>
+    failure_node<error>* make_static_error_node(ErrorCode code, std::string_view explanation, const error_site& site)
+    {
+        const auto node = make_immortal_node<error>(code, explanation, site);
+#ifdef ERR_LATENCY
+        node->value.set_creation_time(error_latency::untimed);
+#endif
+        return node;
+    }
+
+    // Node is a function returning the immortal node of a static error, see static_err
+    template<class Node>
+    failure<failure_ptr<error>> make_static_failure(Node node)
+    {
+        return { .error = failure_ptr<error>(node()) };
+    }
+
+    // the outer error is copied if it is shared, e.g. a static error
     template<class Error = class error>
-    failure<std::decay_t<Error>> make_failure(std::unique_ptr<Error>&& outerError,
-                                              std::unique_ptr<Error>&& innerError)
+    failure<std::decay_t<Error>> make_failure(failure_ptr<Error>&& outerError,
+                                              failure_ptr<Error>&& innerError)
     {
         return
         {
-            .error = std::move(outerError->set_inner_error(std::move(innerError)))
+            .error = std::move(take_failure(std::move(outerError)).set_inner_error(std::move(innerError)))
         };
     }
 }
 
-detail::success<> ok()
+constexpr detail::success<> ok()
 {
     return {};
 }
 
 template<class Value, typename std::enable_if_t<!std::is_lvalue_reference_v<Value>> * = nullptr>
-detail::success<std::remove_const_t<Value>> ok(Value value)
+constexpr detail::success<std::remove_const_t<Value>> ok(Value value)
 {
     return { .value = std::move(value) };
 }
 
+// ok(std::ref(v)) / ok(std::cref(v)) yields a result<T&> / result<const T&> referring to v
+template<class Value>
+constexpr detail::success<Value&> ok(std::reference_wrapper<Value> value)
+{
+    return { .value = value.get() };
+}
+
+// constructs the value directly inside the result, works for non-movable types as well
+template<class Value, class... Args>
+constexpr detail::in_place_success<Value, Args...> ok_in_place(Args&&... args)
+{
+    return { .args = std::forward_as_tuple(std::forward<Args>(args)...) };
+}
+
+// constructs the error directly inside the result, e.g. err_in_place(code, "explanation", FAILURE_SITE(...))
+template<class Error = error, class... Args>
+constexpr detail::in_place_failure<Error, Args...> err_in_place(Args&&... args)
+{
+    return { .args = std::forward_as_tuple(std::forward<Args>(args)...) };
+}
+
 #endif //ERRORHANDLING_MAKE_RESULT_H
@@ -0,0 +1,295 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_MATCH_H
+#define ERRORHANDLING_MATCH_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+#include "error.h"
+
+namespace detail
+{
+    template<class T>
+    concept error_code_type = std::is_base_of_v<error_code, T> && requires { T::id; T::category_id; };
+
+    template<class T>
+    concept error_category_type = std::is_base_of_v<error_category, T> && requires { T::id; };
+
+    template<class Key, class F>
+    struct match_case
+    {
+        F handler;
+    };
+
+    template<class F>
+    struct otherwise_case
+    {
+        F handler;
+    };
+
+    template<class T>
+    struct is_otherwise_case : std::false_type {};
+
+    template<class F>
+    struct is_otherwise_case<otherwise_case<F>> : std::true_type {};
+
+    template<class T>
+    struct match_key;
+
+    template<class Key, class F>
+    struct match_key<match_case<Key, F>>
+    {
+        using type = Key;
+    };
+
+    // dispatch table over the keys of the on<> cases, built at compile time.
+    // the global ids of the matched codes are sparse, they are mapped to a dense table
+    // by a multiplicative perfect hash whose multiplier is searched at compile time:
+    // a multiplication, a shift, a load and a compare, independent of the number of cases.
+    // category wildcards are only consulted if no code matched.
+    template<class... Keys>
+    struct match_table
+    {
+        static constexpr std::size_t size = sizeof...(Keys);
+        static constexpr std::array<bool, size> is_code { error_code_type<Keys>... };
+        static constexpr std::array<uint64_t, size> keys { static_cast<uint64_t>(Keys::id)... };
+        static constexpr std::size_t code_count = std::count(is_code.begin(), is_code.end(), true);
+
+        static_assert(size < UINT16_MAX, "too many cases");
+
+        static constexpr bool unique_keys()
+        {
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                for(std::size_t j = i + 1; j < size; ++j)
+                {
+                    if(is_code[i] == is_code[j] && keys[i] == keys[j])
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        static_assert(unique_keys(), "every error code and category can only be matched once");
+
+        struct hash_function
+        {
+            uint64_t multiplier;
+            unsigned bits;
+
+            [[nodiscard]] constexpr std::size_t operator()(uint64_t id) const
+            {
+                return bits == 0 ? 0 : static_cast<std::size_t>((id * multiplier) >> (64 - bits));
+            }
+        };
+
+        static constexpr bool is_perfect(hash_function hash)
+        {
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                for(std::size_t j = i + 1; j < size; ++j)
+                {
+                    if(is_code[i] && is_code[j] && hash(keys[i]) == hash(keys[j]))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // starts at a table of 4 slots per code and doubles it until a multiplier is found
+        static constexpr hash_function hash = []()
+        {
+            for(auto bits = static_cast<unsigned>(std::bit_width(code_count * 4 - 1)); bits <= 16; ++bits)
+            {
+                uint64_t multiplier = 0x9e3779b97f4a7c15;
+                for(int attempt = 0; attempt < 1024; ++attempt)
+                {
+                    if(is_perfect({ multiplier, bits }))
+                    {
+                        return hash_function { multiplier, bits };
+                    }
+                    // next odd candidate of a 64 bit LCG
+                    multiplier = (multiplier * 6364136223846793005 + 1442695040888963407) | 1;
+                }
+            }
+            return hash_function { 0, 0 };
+        }();
+
+        static_assert(code_count <= 1 || hash.bits != 0, "no perfect hash found for the matched codes");
+
+        struct slot
+        {
+            uint64_t id;
+            uint16_t index; // size for unused slots
+        };
+
+        static constexpr auto slots = []()
+        {
+            std::array<slot, std::size_t { 1 } << hash.bits> result {};
+            for(auto& s : result)
+            {
+                s = { ~uint64_t { 0 }, static_cast<uint16_t>(size) };
+            }
+
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                if(is_code[i])
+                {
+                    result[hash(keys[i])] = { keys[i], static_cast<uint16_t>(i) };
+                }
+            }
+            return result;
+        }();
+
+        struct wildcard
+        {
+            uint32_t category;
+            uint16_t index;
+        };
+
+        static constexpr auto wildcards = []()
+        {
+            std::array<wildcard, size - code_count> result {};
+            std::size_t count = 0;
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                if(!is_code[i])
+                {
+                    result[count++] = { static_cast<uint32_t>(keys[i]), static_cast<uint16_t>(i) };
+                }
+            }
+            return result;
+        }();
+
+        // index of the matching case, size if none matches
+        [[nodiscard]] static constexpr std::size_t find(uint64_t id)
+        {
+            if constexpr(code_count != 0)
+            {
+                const auto& s = slots[hash(id)];
+                if(s.id == id)
+                {
+                    return s.index;
+                }
+            }
+
+            const auto category = static_cast<uint32_t>(id >> 32);
+            for(const auto& w : wildcards)
+            {
+                if(w.category == category)
+                {
+                    return w.index;
+                }
+            }
+
+            return size;
+        }
+    };
+
+    template<class E>
+    constexpr error_code match_code(const E& e)
+    {
+        if constexpr(std::is_same_v<E, error>)
+        {
+            return e.get_code();
+        }
+        else
+        {
+            return code_of(e);
+        }
+    }
+
+    // handlers may take the matched error or nothing
+    template<class F, class E>
+    constexpr decltype(auto) invoke_handler(F& handler, const E& e)
+    {
+        if constexpr(std::is_invocable_v<F&, const E&>)
+        {
+            return std::invoke(handler, e);
+        }
+        else
+        {
+            return std::invoke(handler);
+        }
+    }
+
+    template<class Case, class E>
+    using handler_result_t = decltype(invoke_handler(std::declval<decltype(Case::handler)&>(), std::declval<const E&>()));
+
+    // an if chain over the dense case index, turned into a jump table or a few compares with the handlers inlined
+    template<class R, std::size_t I, std::size_t Last, class Cases, class E>
+    constexpr R invoke_case(std::size_t index, Cases& cases, const E& e)
+    {
+        if constexpr(I == Last)
+        {
+            return invoke_handler(std::get<Last>(cases).handler, e);
+        }
+        else
+        {
+            if(index == I)
+            {
+                return invoke_handler(std::get<I>(cases).handler, e);
+            }
+            return invoke_case<R, I + 1, Last>(index, cases, e);
+        }
+    }
+
+    template<class E, class Cases, std::size_t... I>
+    constexpr decltype(auto) dispatch(const E& e, Cases& cases, std::index_sequence<I...>)
+    {
+        constexpr auto last = sizeof...(I);
+        using table = match_table<typename match_key<std::remove_cvref_t<std::tuple_element_t<I, Cases>>>::type...>;
+        using R = std::common_type_t<handler_result_t<std::remove_cvref_t<std::tuple_element_t<I, Cases>>, E>...,
+                                     handler_result_t<std::remove_cvref_t<std::tuple_element_t<last, Cases>>, E>>;
+
+        // otherwise has the index table::size
+        return invoke_case<R, 0, last>(table::find(match_code(e).get_id()), cases, e);
+    }
+}
+
+// a case of match for an error code or, as a wildcard, for all codes of an error category
+template<class CodeOrCategory, class F>
+constexpr auto on(F&& handler) -> detail::match_case<CodeOrCategory, std::decay_t<F>>
+{
+    static_assert(detail::error_code_type<CodeOrCategory> || detail::error_category_type<CodeOrCategory>,
+                  "on<> expects a type defined with DEFINE_ERROR_CODE or DEFINE_ERROR_CATEGORY");
+    return { std::forward<F>(handler) };
+}
+
+template<class F>
+constexpr auto otherwise(F&& handler) -> detail::otherwise_case<std::decay_t<F>>
+{
+    return { std::forward<F>(handler) };
+}
+
+// invokes the handler of the case matching the code of e, e.g.
+//     match(r.get_error(),
+//           on<io_errors::timeout>([](const error& e) { ... }),
+//           on<io_errors::io_category>([]() { ... }),
+//           otherwise([](const error& e) { ... }));
+// a code case takes precedence over the wildcard of its category, independent of the order of the cases.
+// e may be an error, an error_code or a small error with a to_error_code overload.
+template<class E, class... Cases>
+constexpr decltype(auto) match(const E& e, Cases&&... cases)
+{
+    static_assert(sizeof...(Cases) >= 1 &&
+                  detail::is_otherwise_case<std::decay_t<std::tuple_element_t<sizeof...(Cases) - 1, std::tuple<Cases...>>>>::value,
+                  "the last case of match must be otherwise(handler)");
+
+    auto all = std::forward_as_tuple(cases...);
+    return detail::dispatch(e, all, std::make_index_sequence<sizeof...(Cases) - 1>{});
+}
+
+#endif //ERRORHANDLING_MATCH_H
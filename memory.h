@@ -0,0 +1,206 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_MEMORY_H
+#define ERRORHANDLING_MEMORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+#include "config.h"
+
+namespace detail
+{
+    // nullptr selects std::pmr::get_default_resource()
+    inline std::pmr::memory_resource*& failure_resource_slot() noexcept
+    {
+        thread_local std::pmr::memory_resource* resource = nullptr;
+        return resource;
+    }
+
+    inline std::pmr::memory_resource* current_failure_resource() noexcept
+    {
+        const auto resource = failure_resource_slot();
+        return resource != nullptr ? resource : std::pmr::get_default_resource();
+    }
+
+    // every node remembers the resource it was allocated from,
+    // so it can be released independently of the currently active resource.
+    // nodes are reference counted intrusively, a node with more than one reference is immutable.
+    template<class T>
+    struct failure_node
+    {
+        template<class... Args>
+        explicit failure_node(std::pmr::memory_resource* resource, Args&&... args)
+            : resource(resource)
+            , value(std::forward<Args>(args)...)
+        {
+        }
+
+        std::atomic<std::uint32_t> references { 1 };
+        std::pmr::memory_resource* resource;
+        T value;
+    };
+
+    // reference count of immortal nodes, see make_immortal_node. sharing and releasing them
+    // does not touch the count, so threads using the same immortal error never contend on it
+    constexpr std::uint32_t immortal_references = std::uint32_t { 1 } << 31;
+
+    template<class T>
+    [[nodiscard]] bool is_immortal(const failure_node<T>& node) noexcept
+    {
+        return node.references.load(std::memory_order_relaxed) >= immortal_references;
+    }
+
+    template<class T>
+    struct failure_node_delete
+    {
+        void operator()(failure_node<T>* node) const noexcept
+        {
+            const auto resource = node->resource;
+            std::destroy_at(node);
+            resource->deallocate(node, sizeof(failure_node<T>), alignof(failure_node<T>));
+        }
+    };
+
+    template<class T, class... Args>
+    failure_node<T>* allocate_failure_node(Args&&... args)
+    {
+        const auto resource = current_failure_resource();
+        const auto memory = resource->allocate(sizeof(failure_node<T>), alignof(failure_node<T>));
+
+#if ERR_EXCEPTIONS
+        try
+        {
+            return ::new(memory) failure_node<T>(resource, std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+            resource->deallocate(memory, sizeof(failure_node<T>), alignof(failure_node<T>));
+            throw;
+        }
+#else
+        return ::new(memory) failure_node<T>(resource, std::forward<Args>(args)...);
+#endif
+    }
+}
+
+// owning pointer to a heap allocated error (or error chain node).
+// share() hands out additional owners of the same node, which is immutable from then on.
+// immortal nodes are always shared, they are never freed or modified.
+template<class T>
+class failure_ptr
+{
+public:
+    failure_ptr() = default;
+    failure_ptr(std::nullptr_t) {} // NOLINT(google-explicit-constructor)
+
+    explicit failure_ptr(detail::failure_node<T>* node)
+        : m_node(node)
+    {
+    }
+
+    failure_ptr(failure_ptr&& other) noexcept
+        : m_node(std::exchange(other.m_node, nullptr))
+    {
+    }
+
+    failure_ptr& operator=(failure_ptr&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            m_node = std::exchange(other.m_node, nullptr);
+        }
+
+        return *this;
+    }
+
+    failure_ptr(const failure_ptr&) = delete;
+    failure_ptr& operator=(const failure_ptr&) = delete;
+
+    ~failure_ptr() { reset(); }
+
+    [[nodiscard]] auto get() const -> T* { return m_node ? &m_node->value : nullptr; }
+    [[nodiscard]] auto operator*() const -> T& { return m_node->value; }
+    [[nodiscard]] auto operator->() const -> T* { return &m_node->value; }
+    [[nodiscard]] explicit operator bool() const { return m_node != nullptr; }
+    [[nodiscard]] bool operator==(std::nullptr_t) const { return m_node == nullptr; }
+
+    // costs a single atomic increment, the chain behind the node is not copied
+    [[nodiscard]] failure_ptr share() const
+    {
+        if(m_node && !detail::is_immortal(*m_node))
+        {
+            m_node->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return failure_ptr(m_node);
+    }
+
+    [[nodiscard]] bool is_shared() const
+    {
+        return m_node && m_node->references.load(std::memory_order_acquire) > 1;
+    }
+
+    void reset()
+    {
+        const auto node = std::exchange(m_node, nullptr);
+        if(node && !detail::is_immortal(*node) && node->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            detail::failure_node_delete<T>{}(node);
+        }
+    }
+
+private:
+    detail::failure_node<T>* m_node = nullptr;
+};
+
+template<class T, class... Args>
+failure_ptr<T> make_failure_ptr(Args&&... args)
+{
+    return failure_ptr<T>(detail::allocate_failure_node<T>(std::forward<Args>(args)...));
+}
+
+// routes all failure-path allocations (error nodes, explanations, payloads) of the current thread
+// to the given resource, e.g. a per-request std::pmr::monotonic_buffer_resource.
+// errors must not outlive the resource they were allocated from.
+class failure_memory_scope
+{
+public:
+    explicit failure_memory_scope(std::pmr::memory_resource* resource) noexcept
+        : m_previous(std::exchange(detail::failure_resource_slot(), resource))
+    {
+    }
+
+    failure_memory_scope(const failure_memory_scope&) = delete;
+    failure_memory_scope& operator=(const failure_memory_scope&) = delete;
+
+    ~failure_memory_scope()
+    {
+        detail::failure_resource_slot() = m_previous;
+    }
+
+private:
+    std::pmr::memory_resource* m_previous;
+};
+
+namespace detail
+{
+    // a node that is never freed, e.g. a static error created on first use.
+    // it is allocated from the default heap even inside a failure_memory_scope, the scope's resource may go away
+    template<class T, class... Args>
+    failure_node<T>* make_immortal_node(Args&&... args)
+    {
+        failure_memory_scope scope(std::pmr::new_delete_resource());
+        const auto node = allocate_failure_node<T>(std::forward<Args>(args)...);
+        node->references.store(immortal_references, std::memory_order_relaxed);
+        return node;
+    }
+}
+
+#endif //ERRORHANDLING_MEMORY_H
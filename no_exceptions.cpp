@@ -0,0 +1,142 @@
+//
+// Created by flori on 19.10.2026.
+//
+// tests of the library built with -fno-exceptions -fno-rtti, see ERR_EXCEPTIONS in config.h.
+// what terminates is run in a child process.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+
+#include <doctest/doctest.h>
+
+#define ASSERTIONS_TERMINATE
+
+#include "result.h"
+#include "formatting.h"
+#include "macros.h"
+#include "match.h"
+#include "result_cache.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+static_assert(ERR_EXCEPTIONS == 0, "build with -fno-exceptions");
+
+namespace errors
+{
+    DEFINE_ERROR_CATEGORY(3, general_error_category);
+    DEFINE_ERROR_CODE(1, general_error_category, unknown_error, "Undefined error");
+    DEFINE_ERROR_CODE(2, general_error_category, argument_out_of_range_error, "Argument out of range");
+}
+
+namespace
+{
+    // the wait status of f run in a child process
+    template<class F>
+    int run_in_child(F f)
+    {
+        const auto pid = fork();
+        if(pid == 0)
+        {
+            f();
+            std::_Exit(0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return status;
+    }
+
+    bool aborted(int status)
+    {
+        return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+    }
+
+    result<int> checked(int value)
+    {
+        EXPECT(value >= 0, "value must not be negative");
+        return ok(value);
+    }
+
+    result<int> parse(int value)
+    {
+        if(value > 100)
+        {
+            return err(errors::argument_out_of_range_error{}, "too large", value);
+        }
+        return ok(value);
+    }
+
+    result<int> twice(int value)
+    {
+        TRY_ASSIGN(const auto parsed, parse(value));
+        return ok(parsed * 2);
+    }
+}
+
+TEST_CASE( "Results propagate failures without exceptions" )
+{
+    REQUIRE( twice(21).get_value() == 42 );
+
+    auto r = twice(101);
+    REQUIRE( r.has_failed() );
+    REQUIRE( *r.get_error().get_inner_error() == errors::argument_out_of_range_error{} );
+    REQUIRE( r.get_error().get_inner_error()->get_data<int>() == 101 );
+
+    const auto handled = match(*r.get_error().get_inner_error(),
+                               on<errors::argument_out_of_range_error>([]() { return 1; }),
+                               otherwise([]() { return 0; }));
+    REQUIRE( handled == 1 );
+
+    result_cache<int, int> cache;
+    REQUIRE( (*cache.get_or_load(7, [](const int& key) -> result<int> { return twice(key); })).get_value() == 14 );
+}
+
+TEST_CASE( "Payloads name their type without RTTI" )
+{
+    error e { errors::unknown_error{}, detail::unknown_site };
+    REQUIRE( e.get_data_type() == "void" );
+
+    e.set_data(1);
+    REQUIRE( e.get_data_type() == "int" );
+    REQUIRE( e.holds_data<int>() );
+    REQUIRE( !e.holds_data<std::string>() );
+
+    e.set_data(std::string("data"));
+    REQUIRE( e.get_data_type().find("basic_string") != std::string_view::npos );
+    REQUIRE( fmt::format("{}", e).find("error data type: ") != std::string::npos );
+
+    // bad_data_cast can not be thrown
+    REQUIRE( aborted(run_in_child([&e]() { std::ignore = e.get_data<int>(); })) );
+}
+
+TEST_CASE( "Failed assertions go to the assertion handler" )
+{
+    REQUIRE( checked(1).get_value() == 1 );
+
+    // terminates by default
+    REQUIRE( aborted(run_in_child([]() { std::ignore = checked(-1); })) );
+
+    const auto status = run_in_child([]()
+    {
+        set_assertion_handler([](error&& e)
+        {
+            std::_Exit(e == assertion_errors::precondition_error{} ? 3 : 4);
+        });
+        std::ignore = checked(-1);
+    });
+    REQUIRE( WIFEXITED(status) );
+    REQUIRE( WEXITSTATUS(status) == 3 );
+
+    REQUIRE( aborted(run_in_child([]()
+    {
+        set_assertion_handler(&assertion_handlers::abort);
+        std::ignore = checked(-1);
+    })) );
+
+    REQUIRE( set_assertion_handler(&assertion_handlers::terminate) == &assertion_handlers::terminate );
+}
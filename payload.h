@@ -0,0 +1,220 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_PAYLOAD_H
+#define ERRORHANDLING_PAYLOAD_H
+
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <typeinfo>
+#include <type_traits>
+
+#include "config.h"
+#include "memory.h"
+
+// thrown by error::get_data if the error holds data of another type (if exceptions are enabled)
+class bad_data_cast
+    : public std::bad_cast
+{
+public:
+    [[nodiscard]] const char* what() const noexcept override { return "bad error data cast"; }
+};
+
+namespace detail
+{
+    // spelling of the compiler, e.g. "std::__cxx11::basic_string<char>". needs no RTTI, unlike typeid(T).name()
+    template<class T>
+    [[nodiscard]] constexpr std::string_view type_name()
+    {
+#if defined(__clang__) || defined(__GNUC__)
+        constexpr std::string_view function = __PRETTY_FUNCTION__;
+        constexpr std::string_view prefix = "T = ";
+        constexpr auto first = function.find(prefix) + prefix.size();
+        constexpr auto last = function.find_first_of(";]", first);
+#elif defined(_MSC_VER)
+        constexpr std::string_view function = __FUNCSIG__;
+        constexpr std::string_view prefix = "type_name<";
+        constexpr auto first = function.find(prefix) + prefix.size();
+        constexpr auto last = function.rfind(">(void)");
+#else
+        constexpr std::string_view function = "unknown type";
+        constexpr std::size_t first = 0;
+        constexpr auto last = function.size();
+#endif
+        return function.substr(first, last - first);
+    }
+
+    // type erased error data, replaces std::any so that the data is allocated from the failure resource.
+    // small trivially copyable types are stored inline and never allocate.
+    class payload
+    {
+    public:
+        payload() = default;
+
+        template<class T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, payload>>>
+        explicit payload(T&& value)
+            : m_vtable(&vtable_for<std::decay_t<T>>)
+        {
+            using type = std::decay_t<T>;
+
+            if constexpr(is_inline<type>)
+            {
+                const type v(std::forward<T>(value));
+                std::memcpy(m_storage.buffer, &v, sizeof(type));
+            }
+            else
+            {
+                m_storage.node = allocate_failure_node<type>(std::forward<T>(value));
+            }
+        }
+
+        payload(payload&& other) noexcept
+            : m_vtable(std::exchange(other.m_vtable, nullptr))
+            , m_storage(other.m_storage)
+        {
+        }
+
+        payload& operator=(payload&& other) noexcept
+        {
+            if(this != &other)
+            {
+                reset();
+                m_vtable = std::exchange(other.m_vtable, nullptr);
+                m_storage = other.m_storage;
+            }
+
+            return *this;
+        }
+
+        payload(const payload&) = delete;
+        payload& operator=(const payload&) = delete;
+
+        ~payload() { reset(); }
+
+        // the held type must be copy constructible
+        [[nodiscard]] payload clone() const
+        {
+            payload copy;
+
+            if(m_vtable)
+            {
+                ERR_EXPECTS(m_vtable->copy != nullptr);
+                copy.m_vtable = m_vtable;
+                m_vtable->copy(copy.m_storage, m_storage);
+            }
+
+            return copy;
+        }
+
+        [[nodiscard]] bool has_value() const { return m_vtable != nullptr; }
+
+        template<class T>
+        [[nodiscard]] bool holds() const { return m_vtable == &vtable_for<std::remove_cv_t<T>>; }
+        [[nodiscard]] auto type_name() const -> std::string_view { return m_vtable ? m_vtable->name : "void"; }
+
+        // throws bad_data_cast if the payload does not hold a T, terminates without exceptions
+        template<class T>
+        [[nodiscard]] auto get() -> T&
+        {
+            if(!holds<T>())
+            {
+#if ERR_EXCEPTIONS
+                throw bad_data_cast();
+#else
+                std::terminate();
+#endif
+            }
+
+            return *static_cast<T*>(address());
+        }
+
+        template<class T>
+        [[nodiscard]] auto get() const -> const T&
+        {
+            return const_cast<payload*>(this)->get<T>();
+        }
+
+        void reset()
+        {
+            if(m_vtable)
+            {
+                m_vtable->destroy(m_storage);
+                m_vtable = nullptr;
+            }
+        }
+
+    private:
+        union storage
+        {
+            void* node;
+            alignas(void*) unsigned char buffer[sizeof(void*)];
+        };
+
+        struct vtable
+        {
+            void (*destroy)(storage&);
+            void (*copy)(storage&, const storage&);
+            auto (*value)(storage&) -> void*;
+            std::string_view name;
+        };
+
+        template<class T>
+        static constexpr bool is_inline = std::is_trivially_copyable_v<T> &&
+                                          sizeof(T) <= sizeof(storage) &&
+                                          alignof(T) <= alignof(storage);
+
+        template<class T>
+        static constexpr auto copy_for() -> void (*)(storage&, const storage&)
+        {
+            if constexpr(is_inline<T>)
+            {
+                return [](storage& dst, const storage& src) { dst = src; };
+            }
+            else if constexpr(std::is_copy_constructible_v<T>)
+            {
+                return [](storage& dst, const storage& src)
+                {
+                    dst.node = allocate_failure_node<T>(static_cast<const failure_node<T>*>(src.node)->value);
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        template<class T>
+        static constexpr vtable vtable_for
+        {
+            .destroy = [](storage& s)
+            {
+                if constexpr(!is_inline<T>)
+                {
+                    failure_node_delete<T>{}(static_cast<failure_node<T>*>(s.node));
+                }
+            },
+            .copy = copy_for<T>(),
+            .value = [](storage& s) -> void*
+            {
+                if constexpr(is_inline<T>)
+                {
+                    return s.buffer;
+                }
+                else
+                {
+                    return &static_cast<failure_node<T>*>(s.node)->value;
+                }
+            },
+            .name = detail::type_name<T>()
+        };
+
+        [[nodiscard]] void* address() { return m_vtable->value(m_storage); }
+
+        const vtable* m_vtable = nullptr;
+        storage m_storage {};
+    };
+}
+
+#endif //ERRORHANDLING_PAYLOAD_H
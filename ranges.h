@@ -0,0 +1,318 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_RANGES_H
+#define ERRORHANDLING_RANGES_H
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "result.h"
+
+// lazy pipelines over ranges of results, e.g.
+//     auto records = lines | std::views::transform(parse)
+//                          | result_views::and_then(validate)
+//                          | result_views::map_value(normalize)
+//                          | collect_results();
+// every adaptor works element by element and allocates nothing, collect_results stops at the first failure.
+// failed elements of a container are cloned, not moved out. the clone shares the inner chain (see error::clone).
+namespace detail
+{
+    template<class R>
+    struct result_traits;
+
+    template<class V, class E, class L>
+    struct result_traits<result<V, E, L>>
+    {
+        using value_type = V;
+        using error_type = E;
+    };
+
+    template<class Range>
+    using range_result_traits = result_traits<std::remove_cvref_t<std::ranges::range_reference_t<Range>>>;
+
+    // range | closure, C++20 has no public way to write own range adaptor closures
+    template<class F>
+    struct range_closure
+    {
+        F apply;
+
+        template<std::ranges::viewable_range R>
+        friend constexpr auto operator|(R&& range, const range_closure& closure)
+        {
+            return closure.apply(std::forward<R>(range));
+        }
+    };
+
+    template<class F>
+    range_closure(F) -> range_closure<F>;
+
+    // the error of an element. an element that belongs to a container keeps its error, the copy
+    // shares its inner chain. the result itself is not copied, results with large values can not be
+    template<class R>
+    constexpr auto release_element_error(R&& r)
+    {
+        if constexpr(std::is_lvalue_reference_v<R>)
+        {
+            using error_type = typename result_traits<std::remove_cvref_t<R>>::error_type;
+            if constexpr(std::is_copy_constructible_v<error_type>)
+            {
+                return error_type(r.unchecked_error());
+            }
+            else
+            {
+                return r.unchecked_error().clone();
+            }
+        }
+        else
+        {
+            return std::move(r).release_error();
+        }
+    }
+
+    template<class F>
+    struct and_then_element
+    {
+        F func;
+
+        template<class R>
+        constexpr auto operator()(R&& r) const
+        {
+            using traits = result_traits<std::remove_cvref_t<R>>;
+            using next = std::remove_cvref_t<std::invoke_result_t<const F&, decltype(std::forward<R>(r).unchecked_value())>>;
+            static_assert(std::is_same_v<typename result_traits<next>::error_type, typename traits::error_type>,
+                          "and_then must return a result with the same error type");
+
+            if(r.has_failed())
+            {
+                return next(make_failure(release_element_error(std::forward<R>(r))));
+            }
+            return next(std::invoke(func, std::forward<R>(r).unchecked_value()));
+        }
+    };
+
+    template<class F>
+    struct map_value_element
+    {
+        F func;
+
+        template<class R>
+        constexpr auto operator()(R&& r) const
+        {
+            using value = decltype(std::forward<R>(r).unchecked_value());
+            using next = result<mapped_value_t<const F&, value>, typename result_traits<std::remove_cvref_t<R>>::error_type>;
+
+            if(r.has_failed())
+            {
+                return next(make_failure(release_element_error(std::forward<R>(r))));
+            }
+            return next(success<mapped_value_t<const F&, value>> { std::invoke(func, std::forward<R>(r).unchecked_value()) });
+        }
+    };
+
+    // holds the current element of a pipeline that produces its results on the fly, not copied with the view
+    template<class T>
+    struct element_cache
+    {
+        element_cache() = default;
+        element_cache(const element_cache&) noexcept {}
+        element_cache(element_cache&&) noexcept {}
+        element_cache& operator=(const element_cache&) noexcept { value.reset(); return *this; }
+        element_cache& operator=(element_cache&&) noexcept { value.reset(); return *this; }
+
+        std::optional<T> value;
+    };
+
+    // the values of the successful (Ok) or the errors of the failed results of a range.
+    // results produced on the fly are cached, so the pipeline before the view runs once per element.
+    // single pass, like a generator.
+    template<std::ranges::view V, bool Ok>
+        requires std::ranges::input_range<V>
+    class select_view
+        : public std::ranges::view_interface<select_view<V, Ok>>
+    {
+        using element = std::ranges::range_reference_t<V>;
+        using result_type = std::remove_cvref_t<element>;
+        static constexpr bool caches = !std::is_lvalue_reference_v<element>;
+
+    public:
+        struct sentinel {};
+
+        class iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::remove_cvref_t<decltype(std::declval<select_view&>().current())>;
+
+            iterator() = default;
+            explicit iterator(select_view* parent) : m_parent(parent) {}
+
+            [[nodiscard]] decltype(auto) operator*() const { return m_parent->current(); }
+
+            iterator& operator++()
+            {
+                ++m_parent->m_current;
+                m_parent->satisfy();
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            [[nodiscard]] friend bool operator==(const iterator& it, sentinel)
+            {
+                return it.at_end();
+            }
+
+        private:
+            [[nodiscard]] bool at_end() const { return m_parent->m_current == std::ranges::end(m_parent->m_base); }
+
+            select_view* m_parent = nullptr;
+        };
+
+        select_view() = default;
+        explicit select_view(V base) : m_base(std::move(base)) {}
+
+        [[nodiscard]] iterator begin()
+        {
+            m_current = std::ranges::begin(m_base);
+            satisfy();
+            return iterator(this);
+        }
+
+        [[nodiscard]] sentinel end() const { return {}; }
+
+    private:
+        [[nodiscard]] decltype(auto) current()
+        {
+            if constexpr(Ok && caches)
+            {
+                return std::move(*m_cache.value).unchecked_value();
+            }
+            else if constexpr(Ok)
+            {
+                return m_element->unchecked_value();
+            }
+            else if constexpr(caches)
+            {
+                return std::as_const(*m_cache.value).unchecked_error();
+            }
+            else
+            {
+                return std::as_const(*m_element).unchecked_error();
+            }
+        }
+
+        // advances to the next element that is selected
+        void satisfy()
+        {
+            for(; m_current != std::ranges::end(m_base); ++m_current)
+            {
+                bool ok;
+                if constexpr(caches)
+                {
+                    ok = m_cache.value.emplace(*m_current).is_ok();
+                }
+                else
+                {
+                    m_element = std::addressof(*m_current);
+                    ok = m_element->is_ok();
+                }
+
+                if(ok == Ok)
+                {
+                    return;
+                }
+            }
+        }
+
+        V m_base = V();
+        std::ranges::iterator_t<V> m_current {};
+        element_cache<result_type> m_cache;
+        std::remove_reference_t<element>* m_element = nullptr;
+    };
+
+    template<bool Ok>
+    constexpr auto select_closure()
+    {
+        return range_closure { []<std::ranges::viewable_range R>(R&& range)
+        {
+            return select_view<std::views::all_t<R>, Ok>(std::views::all(std::forward<R>(range)));
+        } };
+    }
+}
+
+namespace result_views
+{
+    // calls f with the value of every successful result, f returns a result with the same error type
+    template<class F>
+    constexpr auto and_then(F f)
+    {
+        return detail::range_closure { [f = std::move(f)]<std::ranges::viewable_range R>(R&& range)
+        {
+            return std::views::transform(std::forward<R>(range), detail::and_then_element<F> { f });
+        } };
+    }
+
+    // maps the value of every successful result, failures pass through
+    template<class F>
+    constexpr auto map_value(F f)
+    {
+        return detail::range_closure { [f = std::move(f)]<std::ranges::viewable_range R>(R&& range)
+        {
+            return std::views::transform(std::forward<R>(range), detail::map_value_element<F> { f });
+        } };
+    }
+
+    // the values of the successful results
+    inline constexpr auto ok_values = detail::select_closure<true>();
+
+    // the errors of the failed results
+    inline constexpr auto errors = detail::select_closure<false>();
+}
+
+// the values of all results of the range in a container, or the first error.
+// stops at the first failure, reserves the size of sized ranges up front.
+template<class Container = void, std::ranges::input_range R>
+auto collect_results(R&& range)
+{
+    using traits = detail::range_result_traits<R>;
+    using container = std::conditional_t<std::is_void_v<Container>, std::vector<std::remove_cvref_t<typename traits::value_type>>, Container>;
+    using collected = result<container, typename traits::error_type>;
+
+    container values;
+    if constexpr(std::ranges::sized_range<R> && requires(container& c, std::size_t n) { c.reserve(n); })
+    {
+        values.reserve(std::ranges::size(range));
+    }
+
+    for(auto&& r : range)
+    {
+        if(r.has_failed())
+        {
+            return collected(detail::make_failure(detail::release_element_error(std::forward<decltype(r)>(r))));
+        }
+        values.insert(values.end(), std::forward<decltype(r)>(r).unchecked_value());
+    }
+
+    return collected(ok(std::move(values)));
+}
+
+// range | collect_results<Container>()
+template<class Container = void>
+constexpr auto collect_results()
+{
+    return detail::range_closure { []<std::ranges::viewable_range R>(R&& range)
+    {
+        return collect_results<Container>(std::forward<R>(range));
+    } };
+}
+
+#endif //ERRORHANDLING_RANGES_H
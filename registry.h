@@ -0,0 +1,329 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_REGISTRY_H
+#define ERRORHANDLING_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "result.h"
+#include "try.h"
+
+// process-wide registry of error categories and codes, e.g. to find the name of a code from its id
+// after deserialization or in a crash handler, and to detect id collisions between shared objects.
+// lookups never lock or allocate, registration is serialized by a mutex.
+// entries are never removed and own copies of their strings, they stay valid after dlclose.
+// the registry is shared by all shared objects of the process as long as they do not hide the symbols
+// of the library (-fvisibility=hidden), which would give every shared object its own instance.
+namespace error_registry
+{
+    DEFINE_ERROR_CATEGORY(0x10001, registry_category);
+    DEFINE_ERROR_CODE(1, registry_category, category_id_collision, "Category id is registered with a different name");
+    DEFINE_ERROR_CODE(2, registry_category, code_id_collision, "Code id is registered with a different name or description");
+    DEFINE_ERROR_CODE(3, registry_category, registry_full, "Error registry is full");
+    DEFINE_ERROR_CODE(4, registry_category, unknown_category, "Category is not registered");
+    DEFINE_ERROR_CODE(5, registry_category, reserved_category_id, "Category id is reserved for allocate_category");
+
+    // allocate_category hands out ids from here on, static category ids must stay below
+    constexpr uint32_t first_dynamic_category_id = 0x4000'0000;
+
+    struct category_info
+    {
+        uint32_t id;
+        std::string_view name;
+        retry_trait retry;
+        bool dynamic; // id allocated by allocate_category
+
+        [[nodiscard]] error_category get_category() const { return { static_cast<int32_t>(id), name, retry }; }
+    };
+
+    struct code_info
+    {
+        uint64_t id;
+        std::string_view name;
+        std::string_view description;
+        retry_trait retry;
+        const category_info* category;
+
+        [[nodiscard]] error_code get_code() const { return { category->get_category(), id, name, description, retry }; }
+    };
+
+    namespace detail
+    {
+        constexpr std::size_t category_capacity = 1024;
+        constexpr std::size_t code_capacity = 16384;
+
+        template<class T>
+        struct entry
+        {
+            T info;
+            std::unique_ptr<char[]> strings;
+        };
+
+        // open addressing, slots are written once under the mutex and published with release stores
+        struct tables
+        {
+            std::mutex mutex;
+            uint32_t next_dynamic_id = first_dynamic_category_id;
+            std::array<std::atomic<const category_info*>, category_capacity> categories {};
+            std::array<std::atomic<const code_info*>, code_capacity> codes {};
+            std::vector<failure_ptr<error>> load_failures;
+        };
+
+        inline tables& get_tables()
+        {
+            static tables instance;
+            return instance;
+        }
+
+        [[nodiscard]] constexpr std::size_t slot_of(uint64_t id, std::size_t capacity)
+        {
+            return static_cast<std::size_t>((id * 0x9e3779b97f4a7c15) >> 32) % capacity;
+        }
+
+        template<class Info, std::size_t N, class Id>
+        [[nodiscard]] const Info* find(const std::array<std::atomic<const Info*>, N>& slots, Id id) noexcept
+        {
+            for(std::size_t probe = 0, slot = slot_of(id, N); probe < N; ++probe, slot = (slot + 1) % N)
+            {
+                const auto info = slots[slot].load(std::memory_order_acquire);
+                if(info == nullptr || info->id == id)
+                {
+                    return info;
+                }
+            }
+            return nullptr;
+        }
+
+        // requires the mutex, the slot of an id that is not registered yet
+        template<class Info, std::size_t N, class Id>
+        [[nodiscard]] std::atomic<const Info*>* free_slot(std::array<std::atomic<const Info*>, N>& slots, Id id)
+        {
+            for(std::size_t probe = 0, slot = slot_of(id, N); probe < N; ++probe, slot = (slot + 1) % N)
+            {
+                if(slots[slot].load(std::memory_order_relaxed) == nullptr)
+                {
+                    return &slots[slot];
+                }
+            }
+            return nullptr;
+        }
+
+        // copies the strings next to each other into one allocation owned by the registry
+        template<std::size_t N>
+        std::unique_ptr<char[]> copy_strings(const std::array<std::string_view, N>& strings, std::array<std::string_view, N>& copies)
+        {
+            std::size_t size = 0;
+            for(const auto s : strings)
+            {
+                size += s.size();
+            }
+
+            auto buffer = std::make_unique<char[]>(size + 1);
+            auto out = buffer.get();
+            for(std::size_t i = 0; i < N; ++i)
+            {
+                copies[i] = { out, strings[i].size() };
+                out = std::copy(strings[i].begin(), strings[i].end(), out);
+            }
+            return buffer;
+        }
+
+        // requires the mutex
+        inline result<const category_info*> insert_category(tables& t, uint32_t id, std::string_view name, retry_trait retry, bool dynamic)
+        {
+            if(const auto existing = find(t.categories, id))
+            {
+                if(existing->name != name)
+                {
+                    return err(category_id_collision{}, name);
+                }
+                return ok(existing);
+            }
+
+            const auto slot = free_slot(t.categories, id);
+            if(slot == nullptr)
+            {
+                return err(registry_full{}, name);
+            }
+
+            std::array<std::string_view, 1> copies;
+            auto strings = copy_strings(std::array { name }, copies);
+            const auto e = new entry<category_info> { { id, copies[0], retry, dynamic }, std::move(strings) };
+            const category_info* info = &e->info;
+            slot->store(info, std::memory_order_release);
+            return ok(info);
+        }
+
+        // requires the mutex. ids from first_dynamic_category_id on belong to allocate_category
+        inline result<const category_info*> insert_static_category(tables& t, const error_category& category)
+        {
+            const auto id = static_cast<uint32_t>(category.get_id());
+            if(id >= first_dynamic_category_id)
+            {
+                return err(reserved_category_id{}, category.get_name());
+            }
+            return insert_category(t, id, category.get_name(), category.get_retry_trait(), false);
+        }
+
+        // requires the mutex
+        inline result<const code_info*> insert_code(tables& t, const error_code& code, const category_info* category)
+        {
+            if(const auto existing = find(t.codes, code.get_id()))
+            {
+                if(existing->name != code.get_name() || existing->description != code.get_description())
+                {
+                    return err(code_id_collision{}, code.get_name());
+                }
+                return ok(existing);
+            }
+
+            const auto slot = free_slot(t.codes, code.get_id());
+            if(slot == nullptr)
+            {
+                return err(registry_full{}, code.get_name());
+            }
+
+            std::array<std::string_view, 2> copies;
+            auto strings = copy_strings(std::array { code.get_name(), code.get_description() }, copies);
+            const auto e = new entry<code_info> { { code.get_id(), copies[0], copies[1], code.get_retry_trait(), category }, std::move(strings) };
+            const code_info* info = &e->info;
+            slot->store(info, std::memory_order_release);
+            return ok(info);
+        }
+    }
+
+    // lock-free, nullptr if the id is not registered
+    [[nodiscard]] inline const category_info* find_category(uint32_t id) noexcept
+    {
+        return detail::find(detail::get_tables().categories, id);
+    }
+
+    [[nodiscard]] inline const code_info* find_code(uint64_t id) noexcept
+    {
+        return detail::find(detail::get_tables().codes, id);
+    }
+
+    // registering the same category again is fine, the same id with a different name is a collision
+    inline result<const category_info*> register_category(const error_category& category)
+    {
+        auto& t = detail::get_tables();
+        std::scoped_lock lock(t.mutex);
+        return detail::insert_static_category(t, category);
+    }
+
+    // registers the category of the code as well
+    inline result<const code_info*> register_code(const error_code& code)
+    {
+        auto& t = detail::get_tables();
+        std::scoped_lock lock(t.mutex);
+
+        TRY_ASSIGN(const auto info, detail::insert_static_category(t, code.get_category()));
+        return detail::insert_code(t, code, info);
+    }
+
+    // a category with an id that is unique in the process, for categories that are only known at runtime.
+    // asking again for the same name returns the same category
+    inline result<error_category> allocate_category(std::string_view name, retry_trait retry = retry_trait::permanent)
+    {
+        auto& t = detail::get_tables();
+        std::scoped_lock lock(t.mutex);
+
+        for(const auto& slot : t.categories)
+        {
+            const auto info = slot.load(std::memory_order_relaxed);
+            if(info && info->dynamic && info->name == name)
+            {
+                return ok(info->get_category());
+            }
+        }
+
+        // skips taken ids, a failed insert would otherwise block every later allocation
+        while(detail::find(t.categories, t.next_dynamic_id) != nullptr)
+        {
+            ++t.next_dynamic_id;
+        }
+
+        TRY_ASSIGN(const auto info, detail::insert_category(t, t.next_dynamic_id, name, retry, true));
+        ++t.next_dynamic_id;
+        return ok(info->get_category());
+    }
+
+    // a code of a registered category, e.g. one from allocate_category. the returned code refers to
+    // the strings of the registry and can outlive name and description
+    inline result<error_code> define_code(const error_category& category,
+                                          uint32_t local_id,
+                                          std::string_view name,
+                                          std::string_view description,
+                                          retry_trait retry)
+    {
+        auto& t = detail::get_tables();
+        std::scoped_lock lock(t.mutex);
+
+        const auto category_info = detail::find(t.categories, static_cast<uint32_t>(category.get_id()));
+        if(category_info == nullptr)
+        {
+            return err(unknown_category{}, category.get_name());
+        }
+
+        const auto id = local_id + (static_cast<uint64_t>(static_cast<uint32_t>(category.get_id())) << 32);
+        TRY_ASSIGN(const auto info, detail::insert_code(t, error_code(category, id, name, description, retry), category_info));
+        return ok(info->get_code());
+    }
+
+    inline result<error_code> define_code(const error_category& category,
+                                          uint32_t local_id,
+                                          std::string_view name,
+                                          std::string_view description)
+    {
+        return define_code(category, local_id, name, description, category.get_retry_trait());
+    }
+
+    // failed registrations of REGISTER_ERROR_CODES, oldest first
+    template<class F>
+    void for_each_load_failure(F&& f)
+    {
+        auto& t = detail::get_tables();
+        std::scoped_lock lock(t.mutex);
+        for(const auto& failure : t.load_failures)
+        {
+            f(*failure);
+        }
+    }
+
+    namespace detail
+    {
+        template<class... Codes>
+        bool register_at_load()
+        {
+            bool registered = true;
+            for(const error_code& code : { static_cast<const error_code&>(Codes{})... })
+            {
+                auto r = register_code(code);
+                if(r.has_failed())
+                {
+                    auto& t = get_tables();
+                    std::scoped_lock lock(t.mutex);
+                    t.load_failures.push_back(std::move(r).release_error());
+                    registered = false;
+                }
+            }
+            return registered;
+        }
+    }
+}
+
+// registers the codes and their categories while the executable or shared object is loaded,
+// collisions are reported by error_registry::for_each_load_failure
+#define REGISTER_ERROR_CODES(...) \
+    [[maybe_unused]] static const bool TRY_UNIQUE_NAME = error_registry::detail::register_at_load<__VA_ARGS__>()
+
+#endif //ERRORHANDLING_REGISTRY_H
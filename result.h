@@ -6,13 +6,13 @@
 #define ERRORHANDLING_RESULT_H
 
 #include <functional>
-#include <gsl/assert>
+#include <iosfwd>
 
 #include "storage.h"
 #include "error.h"
 
 #include "common_errors.h"
-#include "assert.h"
+#include "make_result.h"
 #include "types.h"
 
 namespace detail
@@ -29,8 +29,14 @@ namespace detail
     template<class T>
     using with_default_final_action_t = typename with_default_final_action<T>::type;
 
+    // references returned by the mapping function are kept, i.e. map_value may yield a result<T&>
+    template<class F, class Arg>
+    using mapped_value_t = std::conditional_t<std::is_lvalue_reference_v<std::invoke_result_t<F, Arg>>,
+                                              std::invoke_result_t<F, Arg>,
+                                              std::remove_cvref_t<std::invoke_result_t<F, Arg>>>;
+
     template<class Value, class Error, class FinalAction, class F>
-    auto handle_error(result<Value, Error, FinalAction>&& inner, F&& handler) -> result<Value, Error, FinalAction>
+    constexpr auto handle_error(result<Value, Error, FinalAction>&& inner, F&& handler) -> result<Value, Error, FinalAction>
     {
         static_assert(std::is_same_v<with_default_final_action_t<std::invoke_result_t<F, Error>>,
                                      with_default_final_action_t<result<Value, Error, FinalAction>>>,
@@ -41,14 +47,31 @@ namespace detail
             return std::move(inner);
         }
 
-        auto outer = std::invoke(std::forward<F>(handler), inner.get_error());
+        if constexpr(std::is_same_v<Error, error>)
+        {
+            ERR_TRACE(trace_event_kind::handle, inner.unchecked_error().get_code(), inner.unchecked_error().get_origin());
+            ERR_LATENCY_RECORD(inner.unchecked_error(), true);
+        }
+
+        auto outer = std::invoke(std::forward<F>(handler), inner.unchecked_error());
         if(outer.is_ok())
         {
-            return std::move(outer);
+            // the error is handled, it must not reach the final action of inner
+            std::ignore = std::move(inner).release_error();
+            return outer;
         }
 
-        return detail::make_failure(std::move(outer).release_error(),
-                                    std::move(inner).release_error());
+        if constexpr(is_inline_error_v<Error>)
+        {
+            // inline errors have no chain, the error of the handler replaces the handled one
+            std::ignore = std::move(inner).release_error();
+            return outer;
+        }
+        else
+        {
+            return detail::make_failure(std::move(outer).release_error(),
+                                        std::move(inner).release_error());
+        }
     }
 }
 
@@ -62,31 +85,68 @@ public:
     using result_storage = detail::result_storage<Value, Error>;
     using member_storage = std::tuple<result_storage, FinalAction>; // use tuple for empty-baseclass-optimization
 
-    result(result&&) noexcept = default;
+    constexpr result(result&&) noexcept = default;
+
+    // available for copyable values if the error is heap allocated,
+    // a failed result is copied by sharing its (then immutable) error chain
+    constexpr result(const result&) = default;
 
     template<class V, class E, class F, typename = std::enable_if_t<!std::is_same_v<F, FinalAction>>>
-    result(result<V, E, F>&& r) noexcept
+    constexpr result(result<V, E, F>&& r) noexcept
         : m_data(result_storage(result_storage(std::move(r).release_error()), FinalAction{}))
     {
     }
 
-    result(detail::failure<Error>&& e) // NOLINT(google-explicit-constructor)
+    constexpr result(detail::failure<Error>&& e) // NOLINT(google-explicit-constructor)
         : m_data(result_storage(std::move(e.error)), FinalAction{})
     {
     }
 
-    result(detail::success<Value>&& e) // NOLINT(google-explicit-constructor)
-        : m_data(result_storage(std::move(e.value)), FinalAction{})
+    constexpr result(detail::failure<failure_ptr<Error>>&& e) // NOLINT(google-explicit-constructor)
+        : m_data(result_storage(std::move(e.error)), FinalAction{})
     {
     }
 
-    [[nodiscard]] finline bool is_ok() const { return get_storage().has_value(); }
-    [[nodiscard]] finline bool has_failed() const { return get_storage().has_error(); }
-    [[nodiscard]] finline auto get_error() const & -> const Error& { Expects(has_failed()); return get_storage().get_error(); }
-    [[nodiscard]] finline auto get_value() const & -> const Value& { Expects(is_ok()); return get_storage().get_value(); }
-    [[nodiscard]] finline auto get_error() && -> Error&& { Expects(has_failed()); return std::move(get_storage()).get_error(); }
-    [[nodiscard]] finline auto get_value() && -> Value&& { Expects(is_ok()); return std::move(get_storage()).get_value(); }
-    [[nodiscard]] finline explicit operator bool() const { return is_ok(); }
+    // inline errors from convertible types, e.g. err(code) into a result<V, error_code>
+    template<class E, typename = std::enable_if_t<detail::is_inline_error_v<Error> &&
+                                                  !std::is_same_v<E, Error> &&
+                                                  std::is_constructible_v<Error, E&&>>>
+    constexpr result(detail::failure<E>&& e) // NOLINT(google-explicit-constructor)
+        : result(detail::failure<Error>{ Error(std::move(e.error)) })
+    {
+    }
+
+    constexpr result(detail::success<Value>&& e) // NOLINT(google-explicit-constructor)
+        : m_data(result_storage(std::forward<Value>(e.value)), FinalAction{})
+    {
+    }
+
+    // result_storage is initialized directly from the in-place arguments (guaranteed copy elision)
+    template<class... Args>
+    constexpr result(detail::in_place_success<Value, Args...>&& s) // NOLINT(google-explicit-constructor)
+        : m_data(std::move(s), FinalAction{})
+    {
+    }
+
+    template<class... Args>
+    constexpr result(detail::in_place_failure<Error, Args...>&& f) // NOLINT(google-explicit-constructor)
+        : m_data(std::move(f), FinalAction{})
+    {
+    }
+
+    [[nodiscard]] finline constexpr bool is_ok() const { return get_storage().has_value(); }
+    [[nodiscard]] finline constexpr bool has_failed() const { return get_storage().has_error(); }
+    [[nodiscard]] finline constexpr auto get_error() const & -> const Error& { ERR_EXPECTS(has_failed()); return get_storage().get_error(); }
+    [[nodiscard]] finline constexpr auto get_value() const & -> const Value& { ERR_EXPECTS(is_ok()); return get_storage().get_value(); }
+    [[nodiscard]] finline constexpr auto get_error() && -> Error&& { ERR_EXPECTS(has_failed()); return std::move(get_storage()).get_error(); }
+    [[nodiscard]] finline constexpr auto get_value() && -> Value&& { ERR_EXPECTS(is_ok()); return std::move(get_storage()).get_value(); }
+
+    // for code that checked is_ok() or has_failed() already, only checked in debug builds
+    [[nodiscard]] finline constexpr auto unchecked_error() const & -> const Error& { ERR_DEBUG_EXPECTS(has_failed()); return get_storage().get_error(); }
+    [[nodiscard]] finline constexpr auto unchecked_value() const & -> const Value& { ERR_DEBUG_EXPECTS(is_ok()); return get_storage().get_value(); }
+    [[nodiscard]] finline constexpr auto unchecked_error() && -> Error&& { ERR_DEBUG_EXPECTS(has_failed()); return std::move(get_storage()).get_error(); }
+    [[nodiscard]] finline constexpr auto unchecked_value() && -> Value&& { ERR_DEBUG_EXPECTS(is_ok()); return std::move(get_storage()).get_value(); }
+    [[nodiscard]] finline constexpr explicit operator bool() const { return is_ok(); }
 
 //    template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Error>>>
 //    [[nodiscard]] auto handle_error(F func) & -> decltype(std::invoke(func, get_error()))
@@ -100,49 +160,55 @@ public:
 //    }
 
     template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Error>>>
-    [[nodiscard]] result handle_error(F&& handler)
+    [[nodiscard]] constexpr result handle_error(F&& handler)
     {
         return detail::handle_error(std::move(*this), std::forward<F>(handler));
     }
 
     template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Value>>>
-    [[nodiscard]] auto map_value(F func) & -> result<decltype(std::invoke(func, get_value())), Error>
+    [[nodiscard]] constexpr auto map_value(F func) & -> result<detail::mapped_value_t<F, const Value&>, Error>
     {
         if(has_failed())
         {
-            return std::move(*this);
+            return detail::make_failure(std::move(*this).release_error());
         }
 
-        return ok(std::invoke(func, get_value()));
+        return detail::success<detail::mapped_value_t<F, const Value&>>{ std::invoke(func, unchecked_value()) };
     }
 
     template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Value>>>
-    [[nodiscard]] auto map_value(F func) && -> result<decltype(std::invoke(func, get_value())), Error>
+    [[nodiscard]] constexpr auto map_value(F func) && -> result<detail::mapped_value_t<F, Value&&>, Error>
     {
         if(has_failed())
         {
-            return std::move(*this);
+            return detail::make_failure(std::move(*this).release_error());
         }
 
-        return ok(std::invoke(func, get_value()));
+        return detail::success<detail::mapped_value_t<F, Value&&>>{ std::invoke(func, std::move(*this).unchecked_value()) };
     }
 
-    finline void ignore() const { }
+    finline constexpr void ignore() const { }
 
-    auto release_error() && -> std::unique_ptr<Error>
+    constexpr auto release_error() && -> detail::released_error_t<Error>
     {
-        return std::make_unique<Error>(std::move(get_storage()).get_error());
+        return std::move(get_storage()).release_error();
     }
 
-    ~result()
+    constexpr ~result()
     {
+        if constexpr(std::is_same_v<Error, error>)
+        {
+            ERR_TRACE_IF(has_failed(), trace_event_kind::drop, unchecked_error().get_code(), unchecked_error().get_origin());
+            ERR_LATENCY_RECORD_IF(has_failed(), unchecked_error(), false);
+        }
+
         std::invoke(get_final_action(), *this);
     }
 
 private:
-    [[nodiscard]] auto get_storage() -> result_storage& { return std::get<0>(m_data); }
-    [[nodiscard]] auto get_storage() const -> const result_storage& { return std::get<0>(m_data); }
-    [[nodiscard]] auto get_final_action() -> FinalAction& { return std::get<1>(m_data); }
+    [[nodiscard]] constexpr auto get_storage() -> result_storage& { return std::get<0>(m_data); }
+    [[nodiscard]] constexpr auto get_storage() const -> const result_storage& { return std::get<0>(m_data); }
+    [[nodiscard]] constexpr auto get_final_action() -> FinalAction& { return std::get<1>(m_data); }
 
     member_storage m_data;
 };
@@ -155,39 +221,69 @@ static_assert(sizeof(result<char, error>) == sizeof(detail::result_storage<char,
 static_assert(sizeof(result<char[sizeof(error) + 1], error>) == sizeof(detail::result_storage<char[sizeof(error) + 1], error>),
               "result<T> with default final action must only occupy memory to store the make_failure/value");
 
+// reference
+static_assert(sizeof(result<const char&, error>) == sizeof(const char*) + sizeof(detail::pointer_storage<error>),
+              "result<T&> with default final action must only occupy memory to store the pointer and the error");
+
 template<class Error, class FinalAction>
 class [[nodiscard]] result<void, Error, FinalAction> {
 public:
     static_assert(detail::is_final_action_v<FinalAction, result>,
                   "final action must be invocable and default constructible");
 
-    using error_storage = detail::pointer_storage<Error>;
+    using error_storage = detail::error_storage_t<Error>;
     using member_storage = std::tuple<error_storage, FinalAction>; // use tuple for empty-baseclass-optimization
 
-    result() = default;
+    constexpr result() = default;
+
+    constexpr result(result&&) noexcept = default;
 
-    result(result&&) noexcept = default;
+    // a failed result is copied by sharing its (then immutable) error chain
+    constexpr result(const result&) = default;
 
     template<class E, class F, typename = std::enable_if_t<!std::is_same_v<F, FinalAction>>>
-    result(result<void, E, F>&& r) noexcept // NOLINT(google-explicit-constructor)
+    constexpr result(result<void, E, F>&& r) noexcept // NOLINT(google-explicit-constructor)
         : m_data(error_storage(std::move(r).release_error()), FinalAction{})
     {
     }
 
-    result(detail::success<> &&) // NOLINT(google-explicit-constructor)
+    constexpr result(detail::success<> &&) // NOLINT(google-explicit-constructor)
     {
     }
 
-    result(detail::failure<Error> &&e) // NOLINT(google-explicit-constructor)
+    constexpr result(detail::failure<Error> &&e) // NOLINT(google-explicit-constructor)
         : m_data(error_storage(std::move(e.error)), FinalAction{})
     {
     }
 
-    [[nodiscard]] finline bool is_ok() const { return !get_error_storage().has_value(); }
-    [[nodiscard]] finline bool has_failed() const { return get_error_storage().has_value(); }
-    [[nodiscard]] finline auto get_error() const & -> const Error& { Expects(has_failed()); return get_error_storage().get(); }
-    [[nodiscard]] finline auto get_error() && -> Error&& { Expects(has_failed()); return std::move(get_error_storage()).get(); }
-    [[nodiscard]] finline explicit operator bool() const { return is_ok(); }
+    constexpr result(detail::failure<failure_ptr<Error>>&& e) // NOLINT(google-explicit-constructor)
+        : m_data(error_storage(std::move(e.error)), FinalAction{})
+    {
+    }
+
+    template<class E, typename = std::enable_if_t<detail::is_inline_error_v<Error> &&
+                                                  !std::is_same_v<E, Error> &&
+                                                  std::is_constructible_v<Error, E&&>>>
+    constexpr result(detail::failure<E>&& e) // NOLINT(google-explicit-constructor)
+        : result(detail::failure<Error>{ Error(std::move(e.error)) })
+    {
+    }
+
+    template<class... Args>
+    constexpr result(detail::in_place_failure<Error, Args...>&& f) // NOLINT(google-explicit-constructor)
+        : result(std::move(f), std::index_sequence_for<Args...>{})
+    {
+    }
+
+    [[nodiscard]] finline constexpr bool is_ok() const { return !get_error_storage().has_value(); }
+    [[nodiscard]] finline constexpr bool has_failed() const { return get_error_storage().has_value(); }
+    [[nodiscard]] finline constexpr auto get_error() const & -> const Error& { ERR_EXPECTS(has_failed()); return get_error_storage().get(); }
+    [[nodiscard]] finline constexpr auto get_error() && -> Error&& { ERR_EXPECTS(has_failed()); return std::move(get_error_storage()).get(); }
+
+    // for code that checked has_failed() already, only checked in debug builds
+    [[nodiscard]] finline constexpr auto unchecked_error() const & -> const Error& { ERR_DEBUG_EXPECTS(has_failed()); return get_error_storage().get(); }
+    [[nodiscard]] finline constexpr auto unchecked_error() && -> Error&& { ERR_DEBUG_EXPECTS(has_failed()); return std::move(get_error_storage()).get(); }
+    [[nodiscard]] finline constexpr explicit operator bool() const { return is_ok(); }
 
 //    template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Error>>>
 //    [[nodiscard]] auto handle_error(F func) & -> decltype(std::invoke(func, get_error()))
@@ -201,31 +297,43 @@ public:
 //    }
 
     template<class F, typename = std::enable_if_t<std::is_invocable_v<F, Error>>>
-    [[nodiscard]] result handle_error(F&& handler) // -> decltype(std::invoke(func, get_error()))
+    [[nodiscard]] constexpr result handle_error(F&& handler) // -> decltype(std::invoke(func, get_error()))
     {
         return detail::handle_error(std::move(*this), std::forward<F>(handler));
     }
 
     // will NOT suppress call of final action
-    //    finline void ignore() const { }
+    //    finline constexpr void ignore() const { }
 
     // will suppress call of final action
-    finline void dismiss() { get_error_storage().reset(); }
+    finline constexpr void dismiss() { get_error_storage().reset(); }
 
-    auto release_error() && -> std::unique_ptr<Error>
+    constexpr auto release_error() && -> detail::released_error_t<Error>
     {
-        return std::unique_ptr<Error>(get_error_storage().release());
+        return get_error_storage().release();
     }
 
-    ~result()
+    constexpr ~result()
     {
+        if constexpr(std::is_same_v<Error, error>)
+        {
+            ERR_TRACE_IF(has_failed(), trace_event_kind::drop, unchecked_error().get_code(), unchecked_error().get_origin());
+            ERR_LATENCY_RECORD_IF(has_failed(), unchecked_error(), false);
+        }
+
         std::invoke(get_final_action(), *this);
     }
 
 private:
-    [[nodiscard]] auto get_error_storage() -> error_storage& { return std::get<0>(m_data); }
-    [[nodiscard]] auto get_error_storage() const -> const error_storage& { return std::get<0>(m_data); }
-    [[nodiscard]] auto get_final_action() const -> const FinalAction& { return std::get<1>(m_data); }
+    template<class... Args, std::size_t... I>
+    constexpr result(detail::in_place_failure<Error, Args...>&& f, std::index_sequence<I...>)
+        : m_data(error_storage(std::in_place, std::get<I>(std::move(f.args))...), FinalAction{})
+    {
+    }
+
+    [[nodiscard]] constexpr auto get_error_storage() -> error_storage& { return std::get<0>(m_data); }
+    [[nodiscard]] constexpr auto get_error_storage() const -> const error_storage& { return std::get<0>(m_data); }
+    [[nodiscard]] constexpr auto get_final_action() const -> const FinalAction& { return std::get<1>(m_data); }
 
     member_storage m_data;
 };
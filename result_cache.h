@@ -0,0 +1,316 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_RESULT_CACHE_H
+#define ERRORHANDLING_RESULT_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "result.h"
+
+struct result_cache_options
+{
+    std::size_t capacity = 1024; // entries, split evenly across the shards
+    std::size_t shards = 16;
+    std::chrono::steady_clock::duration ok_ttl = std::chrono::minutes(5);
+    std::chrono::steady_clock::duration failure_ttl = std::chrono::seconds(5); // negative caching
+};
+
+// memoizes results of expensive loads, including failures.
+// each shard evicts with CLOCK (second chance), concurrent loads of the same key are deduplicated.
+// hits return a shared handle to the cached result and neither allocate nor copy the error chain.
+template<class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class result_cache
+{
+public:
+    using result_type = result<Value>;
+    using handle = std::shared_ptr<const result_type>;
+
+    explicit result_cache(result_cache_options options = {})
+        : m_options(options)
+        , m_shards(std::max<std::size_t>(options.shards, 1))
+    {
+        const auto per_shard = std::max<std::size_t>(options.capacity / m_shards.size(), 1);
+        for(auto& shard : m_shards)
+        {
+            shard.slots = std::make_unique<slot[]>(per_shard);
+            shard.free.reserve(per_shard);
+            shard.capacity = per_shard;
+        }
+    }
+
+    // returns nullptr on a miss or if the entry expired, expired entries are dropped
+    [[nodiscard]] handle find(const Key& key)
+    {
+        auto& shard = shard_for(key);
+        const auto now = clock::now();
+
+        {
+            bool expired = false;
+            std::shared_lock lock(shard.mutex);
+            if(auto cached = lookup(shard, key, now, expired); cached || !expired)
+            {
+                return cached;
+            }
+        }
+
+        std::unique_lock lock(shard.mutex);
+        drop_expired(shard, key, now);
+        return nullptr;
+    }
+
+    // loader is invoked without any lock held and must return a result<Value>
+    template<class Loader>
+    [[nodiscard]] handle get_or_load(const Key& key, Loader&& loader)
+    {
+        static_assert(std::is_same_v<std::invoke_result_t<Loader, const Key&>, result_type>,
+                      "loader must return result<Value>");
+
+        auto& shard = shard_for(key);
+
+        {
+            bool expired = false;
+            std::shared_lock lock(shard.mutex);
+            if(auto cached = lookup(shard, key, clock::now(), expired))
+            {
+                return cached;
+            }
+        }
+
+        std::promise<handle> promise;
+
+        {
+            std::unique_lock lock(shard.mutex);
+            const auto now = clock::now();
+            bool expired = false;
+            if(auto cached = lookup(shard, key, now, expired))
+            {
+                return cached;
+            }
+
+            if(expired)
+            {
+                drop_expired(shard, key, now);
+            }
+
+            if(const auto pending = shard.loading.find(key); pending != shard.loading.end())
+            {
+                auto future = pending->second;
+                lock.unlock();
+                return future.get();
+            }
+
+            shard.loading.emplace(key, promise.get_future().share());
+        }
+
+        handle loaded;
+#if ERR_EXCEPTIONS
+        try
+        {
+            loaded = std::make_shared<const result_type>(std::invoke(std::forward<Loader>(loader), key));
+        }
+        catch(...)
+        {
+            {
+                std::unique_lock lock(shard.mutex);
+                shard.loading.erase(key);
+            }
+
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+#else
+        loaded = std::make_shared<const result_type>(std::invoke(std::forward<Loader>(loader), key));
+#endif
+
+        {
+            std::unique_lock lock(shard.mutex);
+            insert(shard, key, loaded);
+            shard.loading.erase(key);
+        }
+
+        promise.set_value(loaded);
+        return loaded;
+    }
+
+    void erase(const Key& key)
+    {
+        auto& shard = shard_for(key);
+        std::unique_lock lock(shard.mutex);
+
+        if(const auto it = shard.index.find(key); it != shard.index.end())
+        {
+            release(shard, it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        for(auto& shard : m_shards)
+        {
+            std::unique_lock lock(shard.mutex);
+            for(const auto& [key, index] : shard.index)
+            {
+                release(shard.slots[index]);
+            }
+            shard.index.clear();
+            shard.free.clear();
+            shard.used = 0;
+            shard.hand = 0;
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        std::size_t size = 0;
+        for(const auto& shard : m_shards)
+        {
+            std::shared_lock lock(shard.mutex);
+            size += shard.index.size();
+        }
+        return size;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct slot
+    {
+        const Key* key = nullptr; // points into the index
+        handle value;
+        clock::time_point expires;
+        mutable std::atomic<bool> referenced { false };
+    };
+
+    struct shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, std::size_t, Hash, KeyEqual> index;
+        std::unordered_map<Key, std::shared_future<handle>, Hash, KeyEqual> loading;
+        std::unique_ptr<slot[]> slots;
+        std::vector<std::size_t> free; // released slots below used
+        std::size_t capacity = 0;
+        std::size_t used = 0;
+        std::size_t hand = 0;
+    };
+
+    [[nodiscard]] auto shard_for(const Key& key) -> shard& { return m_shards[Hash{}(key) % m_shards.size()]; }
+    [[nodiscard]] auto shard_for(const Key& key) const -> const shard& { return m_shards[Hash{}(key) % m_shards.size()]; }
+
+    // requires at least a shared lock. expired entries are misses, they are dropped by drop_expired
+    static handle lookup(const shard& shard, const Key& key, clock::time_point now, bool& expired)
+    {
+        const auto it = shard.index.find(key);
+        if(it == shard.index.end())
+        {
+            return nullptr;
+        }
+
+        const auto& entry = shard.slots[it->second];
+        if(entry.expires <= now)
+        {
+            expired = true;
+            return nullptr;
+        }
+
+        if(!entry.referenced.load(std::memory_order_relaxed))
+        {
+            entry.referenced.store(true, std::memory_order_relaxed);
+        }
+
+        return entry.value;
+    }
+
+    // requires the unique lock
+    void insert(shard& shard, const Key& key, handle value)
+    {
+        const auto ttl = value->is_ok() ? m_options.ok_ttl : m_options.failure_ttl;
+
+        auto it = shard.index.find(key);
+        if(it == shard.index.end())
+        {
+            const auto index = take_slot(shard);
+            it = shard.index.emplace(key, index).first;
+            shard.slots[index].key = &it->first;
+        }
+
+        auto& entry = shard.slots[it->second];
+        entry.value = std::move(value);
+        entry.expires = clock::now() + ttl;
+        entry.referenced.store(false, std::memory_order_relaxed);
+    }
+
+    // requires the unique lock, checks again as the entry may have been reloaded in between
+    static void drop_expired(shard& shard, const Key& key, clock::time_point now)
+    {
+        if(const auto it = shard.index.find(key); it != shard.index.end() && shard.slots[it->second].expires <= now)
+        {
+            release(shard, it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    // released slots first, the CLOCK only evicts if the shard is full
+    static std::size_t take_slot(shard& shard)
+    {
+        if(!shard.free.empty())
+        {
+            const auto index = shard.free.back();
+            shard.free.pop_back();
+            return index;
+        }
+
+        return shard.used < shard.capacity ? shard.used++ : evict(shard);
+    }
+
+    static void release(slot& entry)
+    {
+        entry.key = nullptr;
+        entry.value.reset();
+    }
+
+    static void release(shard& shard, std::size_t index)
+    {
+        release(shard.slots[index]);
+        shard.free.push_back(index);
+    }
+
+    // CLOCK: the hand clears reference bits until it finds an entry that was not used since the last sweep
+    static std::size_t evict(shard& shard)
+    {
+        for(;;)
+        {
+            const auto index = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.capacity;
+
+            auto& entry = shard.slots[index];
+            if(entry.key && entry.referenced.exchange(false, std::memory_order_relaxed))
+            {
+                continue;
+            }
+
+            if(entry.key)
+            {
+                shard.index.erase(shard.index.find(*entry.key));
+                release(entry);
+            }
+
+            return index;
+        }
+    }
+
+    result_cache_options m_options;
+    std::vector<shard> m_shards;
+};
+
+#endif //ERRORHANDLING_RESULT_CACHE_H
@@ -0,0 +1,190 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_RESULT_MACROS_H
+#define ERRORHANDLING_RESULT_MACROS_H
+
+// all macros of the library and nothing else.
+// the names they expand to come from try.h and assert.h.
+#include "config.h"
+
+// the optional last argument is the retry_trait of the category, permanent by default
+// ids must be unique, a second category or code with the same id in a translation unit does not compile
+#define DEFINE_ERROR_CATEGORY(id, name, ...) \
+    struct name : error_category_base<id>\
+    {\
+        constexpr name()\
+            : error_category_base<id>(#name __VA_OPT__(,) __VA_ARGS__) {}\
+        static_assert(::detail::unique_error_id<::detail::category_id_kind, id, name>::value);\
+    }
+
+// the optional last argument is the retry_trait of the code, the one of its category by default
+#define DEFINE_ERROR_CODE(id, category, name, description, ...) \
+    struct name : error_code_base<id, category>\
+    {                           \
+        constexpr name() : error_code_base<id, category>(#name, description __VA_OPT__(,) __VA_ARGS__) {}\
+        static_assert(::detail::unique_error_id<::detail::code_id_kind, to_global_id<id>(category{}), name>::value);\
+    }
+
+#define CAT( A, B ) A ## B
+#define SELECT( NAME, NUM ) CAT( NAME ## _, NUM )
+
+#define GET_COUNT( _1, _2, _3, _4, _5, _6 /* ad nauseam */, COUNT, ... ) COUNT
+#define VA_SIZE( ... ) GET_COUNT( __VA_ARGS__, 6, 5, 4, 3, 2, 1 )
+
+#define VA_SELECT( NAME, ... ) SELECT( NAME, VA_SIZE(__VA_ARGS__) )(__VA_ARGS__)
+
+#define TRY_GLUE2(x, y) x##y
+#define TRY_GLUE(x, y) TRY_GLUE2(x, y)
+#define TRY_UNIQUE_NAME TRY_GLUE(_result_unique_name_temporary, __COUNTER__)
+
+// one static error_site per expansion. the lambda keeps the descriptor usable from constexpr functions,
+// a LAZY_ site is only invoked where the descriptor is needed, so constant evaluation never touches it
+#if ERR_VERBOSITY >= ERR_VERBOSITY_FULL
+
+#define LAZY_ERROR_SITE_IMPL(expression_text, code_text) \
+    ([]() noexcept -> const ::error_site& \
+    { \
+        static constexpr ::error_site site { __FILE__, \
+                                             __LINE__, \
+                                             ::detail::enclosing_function(std::source_location::current().function_name()), \
+                                             expression_text, \
+                                             code_text, \
+                                             ::detail::site_id(__FILE__, __LINE__) }; \
+        return site; \
+    })
+
+#define ERR_EXPLANATION(explanation) explanation
+
+#else
+
+#if ERR_VERBOSITY >= ERR_VERBOSITY_LINES
+#define LAZY_ERROR_SITE_IMPL(expression_text, code_text) \
+    ([]() noexcept -> const ::error_site& \
+    { \
+        static constexpr ::error_site site { "", __LINE__, "", "", "", ::detail::site_id(__FILE__, __LINE__) }; \
+        return site; \
+    })
+#else
+#define LAZY_ERROR_SITE_IMPL(expression_text, code_text) \
+    ([]() noexcept -> const ::error_site& { return ::detail::unknown_site; })
+#endif
+
+// not evaluated, sizeof only keeps variables that are passed as explanation in use
+#define ERR_EXPLANATION(explanation) ((void)sizeof(explanation), ::std::string_view())
+
+#endif // ERR_VERBOSITY >= ERR_VERBOSITY_FULL
+
+#define LAZY_FAILURE_SITE(expr) LAZY_ERROR_SITE_IMPL(#expr, "")
+
+#define FAILURE_SITE(expr) (LAZY_FAILURE_SITE(expr)())
+
+// the site of err(code, ...)
+#define ERROR_SITE(code) (LAZY_ERROR_SITE_IMPL("", #code)())
+
+#define TRY_ASSIGN_IMPL(init, result_name, expr) \
+    auto result_name = (expr); \
+    if(ERR_UNLIKELY(result_name.has_failed())) \
+    { \
+        return ::detail::propagate_failure(LAZY_FAILURE_SITE(expr), std::move(result_name)); \
+    } \
+    init = std::move(result_name).unchecked_value()
+
+#define TRY_IMPL(result_name, expr) \
+    do { \
+        auto result_name = (expr); \
+        if(ERR_UNLIKELY(result_name.has_failed())) \
+        { \
+            return ::detail::propagate_failure(LAZY_FAILURE_SITE(expr), std::move(result_name)); \
+        } \
+    } while(false)
+
+#define RETURN_IMPL(result_name, expr) \
+    do { \
+        auto result_name = (expr); \
+        if(ERR_UNLIKELY(result_name.has_failed())) \
+        { \
+            return ::detail::propagate_failure(LAZY_FAILURE_SITE(expr), std::move(result_name)); \
+        } \
+        return result_name; \
+    } while(false)
+
+#define TRY_ASSIGN(init, expr) TRY_ASSIGN_IMPL(init, TRY_UNIQUE_NAME, expr)
+
+#if defined(__GNUC__) || defined(__clang__)
+
+// expression-position TRY, e.g. foo(TRYX(bar())), based on statement expressions.
+// the value is moved out of the result once, like TRY_ASSIGN does: it is a member of the result,
+// so that move can not be elided. what TRYX saves is the separate declaration
+#define TRYX_IMPL(result_name, expr) \
+    ({ \
+        auto result_name = (expr); \
+        if(ERR_UNLIKELY(result_name.has_failed())) \
+        { \
+            return ::detail::propagate_failure(LAZY_FAILURE_SITE(expr), std::move(result_name)); \
+        } \
+        ::detail::tryx_value(std::move(result_name)); \
+    })
+
+#else
+
+// without statement expressions a failure can not be returned from the enclosing function,
+// TRYX does not compile there. TRY_ASSIGN works with every compiler
+#define TRYX_IMPL(result_name, expr) \
+    ([]() { static_assert(false, "TRYX needs statement expressions (GCC, Clang), use TRY_ASSIGN"); }(), (expr))
+
+#endif // defined(__GNUC__) || defined(__clang__)
+
+#define TRYX(expr) TRYX_IMPL(TRY_UNIQUE_NAME, expr)
+
+#define TRY(expr) TRY_IMPL(TRY_UNIQUE_NAME, expr)
+
+#define RETURN(expr) RETURN_IMPL(TRY_UNIQUE_NAME, expr)
+
+// err(code) creates an inline error, for result<V, E> with trivially copyable E (see detail::inline_storage)
+#define ERR_1(code) ::detail::make_failure(code)
+
+#define ERR_2(code, explanation) ::detail::make_failure(code, ERR_EXPLANATION(explanation), ERROR_SITE(code))
+
+#define ERR_3(code, explanation, result_or_data) \
+    ::detail::resolve_failed_result(code, ERR_EXPLANATION(explanation), result_or_data, ERROR_SITE(code));
+
+#define ERR_4(code, explanation, data, result) \
+    ::detail::resolve_failed_result(code, ERR_EXPLANATION(explanation), result, data, ERROR_SITE(code));
+
+#define err( ... ) VA_SELECT( ERR, __VA_ARGS__ )
+
+// for frequent failures without cause or data (cache misses, full queues, ...): the error is created on first use
+// and shared by all results returned here, which then cost a pointer store. it is never freed or modified,
+// attaching a cause or data copies it. code and explanation must not refer to local variables.
+#define static_err(code, explanation) \
+    ::detail::make_static_failure([]() -> ::detail::failure_node<::error>* \
+    { \
+        static const auto node = ::detail::make_static_error_node(code, ERR_EXPLANATION(explanation), ERROR_SITE(code)); \
+        return node; \
+    })
+
+#define EXPECT_IMPL(result_name, expr, explanation) \
+    do { \
+        auto&& result_name = (expr); \
+        if(ERR_UNLIKELY(!static_cast<bool>(result_name))) \
+        { \
+            return fail_precondition(std::move(result_name), FAILURE_SITE(expr), ERR_EXPLANATION(explanation)); \
+        } \
+    } while(false)
+
+#define EXPECT(expr, explanation) EXPECT_IMPL(TRY_UNIQUE_NAME, expr, explanation)
+
+#define ENSURE_IMPL(result_name, expr, explanation) \
+    do { \
+        auto&& result_name = (expr); \
+        if(ERR_UNLIKELY(!static_cast<bool>(result_name))) \
+        { \
+            return fail_postcondition(std::move(result_name), FAILURE_SITE(expr), ERR_EXPLANATION(explanation)); \
+        } \
+    } while(false)
+
+#define ENSURE(expr, explanation) ENSURE_IMPL(TRY_UNIQUE_NAME, expr, explanation)
+
+#endif //ERRORHANDLING_RESULT_MACROS_H
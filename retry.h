@@ -0,0 +1,247 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_RETRY_H
+#define ERRORHANDLING_RETRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <source_location>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "result.h"
+#include "try.h"
+
+// shared between all callers of a dependency, limits retries to a fraction of the successful calls
+// so that retries cannot multiply the load on a dependency that is already failing.
+// lock-free token bucket in fixed point, every success deposits ratio tokens, every retry withdraws one.
+class retry_budget
+{
+public:
+    explicit retry_budget(double ratio = 0.1, double max_tokens = 10.0)
+        : m_deposit(to_fixed(ratio))
+        , m_max(to_fixed(max_tokens))
+        , m_tokens(m_max)
+    {
+    }
+
+    retry_budget(const retry_budget&) = delete;
+    retry_budget& operator=(const retry_budget&) = delete;
+
+    void deposit()
+    {
+        auto tokens = m_tokens.load(std::memory_order_relaxed);
+        while(tokens < m_max &&
+              !m_tokens.compare_exchange_weak(tokens, std::min(tokens + m_deposit, m_max), std::memory_order_relaxed))
+        {
+        }
+    }
+
+    [[nodiscard]] bool try_withdraw()
+    {
+        auto tokens = m_tokens.load(std::memory_order_relaxed);
+        while(tokens >= one)
+        {
+            if(m_tokens.compare_exchange_weak(tokens, tokens - one, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] double get_tokens() const { return static_cast<double>(m_tokens.load(std::memory_order_relaxed)) / one; }
+
+private:
+    static constexpr std::int64_t one = 1000;
+
+    static std::int64_t to_fixed(double value) { return static_cast<std::int64_t>(value * one); }
+
+    std::int64_t m_deposit;
+    std::int64_t m_max;
+    std::atomic<std::int64_t> m_tokens;
+};
+
+struct retry_policy
+{
+    std::uint32_t max_attempts = 3; // including the first one
+    std::chrono::nanoseconds initial_backoff = std::chrono::milliseconds(10);
+    std::chrono::nanoseconds max_backoff = std::chrono::seconds(1);
+    double multiplier = 2.0;
+    double throttled_multiplier = 4.0; // applied on top of the backoff for retry_trait::throttled
+    double jitter = 0.5; // fraction of every delay that is randomized, 1.0 is "full jitter"
+    std::chrono::nanoseconds max_total_delay = std::chrono::seconds(5); // time budget for all backoffs of one call
+    retry_budget* budget = nullptr; // optional, shared between calls
+    void (*sleep)(std::chrono::nanoseconds) = [](std::chrono::nanoseconds delay) { std::this_thread::sleep_for(delay); };
+};
+
+// attached to the basic_errors::retries_exhausted error, the last attempt is its inner error
+struct retry_history
+{
+    retry_history() = default;
+    retry_history(retry_history&&) noexcept = default;
+    retry_history& operator=(retry_history&&) noexcept = default;
+
+    retry_history(const retry_history& other)
+        : attempts(other.attempts.get_allocator())
+    {
+        attempts.reserve(other.attempts.size());
+        for(const auto& attempt : other.attempts)
+        {
+            attempts.push_back(attempt.share());
+        }
+    }
+
+    // oldest first
+    std::pmr::vector<failure_ptr<error>> attempts { detail::current_failure_resource() };
+};
+
+namespace detail
+{
+    // sites of runtime std::source_locations, i.e. the default argument of retry.
+    // interned once per file and line, only on the failure path, and never freed
+    inline const error_site& intern_site(const std::source_location& location)
+    {
+        static std::mutex mutex;
+        static auto& sites = *new std::map<std::pair<const char*, uint_least32_t>, error_site>;
+
+        std::scoped_lock lock(mutex);
+        return sites.try_emplace({ location.file_name(), location.line() },
+                                 error_site { location.file_name(),
+                                              static_cast<int>(location.line()),
+                                              location.function_name(),
+                                              "",
+                                              "",
+                                              site_id(location.file_name(), static_cast<int>(location.line())) }).first->second;
+    }
+
+    inline double retry_jitter_sample()
+    {
+        thread_local std::minstd_rand engine { std::random_device{}() };
+        return std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+    }
+
+    inline std::chrono::nanoseconds retry_delay(const retry_policy& policy, std::chrono::nanoseconds backoff, retry_trait trait)
+    {
+        auto delay = static_cast<double>(backoff.count());
+        if(trait == retry_trait::throttled)
+        {
+            delay *= policy.throttled_multiplier;
+        }
+
+        delay = std::min(delay, static_cast<double>(policy.max_backoff.count()));
+        delay *= 1.0 - policy.jitter * retry_jitter_sample();
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(delay));
+    }
+
+    // small errors name their code through code_of, see is_inline_error_v
+    template<class Error>
+    constexpr retry_trait retry_trait_of(const Error& e)
+    {
+        if constexpr(is_inline_error_v<Error>)
+        {
+            return code_of(e).get_retry_trait();
+        }
+        else
+        {
+            return e.get_code().get_retry_trait();
+        }
+    }
+
+    template<class Result>
+    ERR_COLD Result retries_exhausted(Result&& last, retry_history&& history, const error_site& site)
+    {
+        constexpr std::string_view prefix = "gave up after ";
+        constexpr std::string_view suffix = " attempts";
+
+        char explanation[64];
+        auto end = std::copy(prefix.begin(), prefix.end(), explanation);
+        end = std::to_chars(end, explanation + sizeof(explanation) - suffix.size(), history.attempts.size() + 1).ptr;
+        end = std::copy(suffix.begin(), suffix.end(), end);
+
+        return detail::make_failure(basic_errors::retries_exhausted{},
+                                    std::string_view(explanation, end - explanation),
+                                    std::move(last).release_error(),
+                                    std::move(history),
+                                    site);
+    }
+}
+
+// invokes fn until it succeeds, fails with a permanent error or the policy gives up.
+// whether an error is retried is decided by the retry_trait of its code, no lookup happens at runtime.
+// if the call is retried and still fails, the error is basic_errors::retries_exhausted
+// with the last attempt as inner error and the earlier ones in a retry_history.
+// small errors (see is_inline_error_v) can not carry a history, the last attempt is returned as it is.
+template<class F>
+auto retry(F&& fn,
+           const retry_policy& policy = {},
+           const std::source_location& location = std::source_location::current()) -> std::invoke_result_t<F&>
+{
+    using result_type = std::invoke_result_t<F&>;
+    static_assert(is_result_t<result_type>::value, "fn must return a result");
+
+    auto backoff = policy.initial_backoff;
+    std::chrono::nanoseconds total_delay {};
+    retry_history history;
+
+    for(std::uint32_t attempt = 1;; ++attempt)
+    {
+        auto r = std::invoke(fn);
+        if(ERR_LIKELY(r.is_ok()))
+        {
+            if(policy.budget)
+            {
+                policy.budget->deposit();
+            }
+
+            return r;
+        }
+
+        using error_type = std::remove_cvref_t<decltype(r.unchecked_error())>;
+        constexpr bool keeps_history = !detail::is_inline_error_v<error_type>;
+
+        const auto trait = detail::retry_trait_of(r.unchecked_error());
+        const auto delay = detail::retry_delay(policy, backoff, trait);
+
+        const auto give_up = trait == retry_trait::permanent ||
+                             attempt >= policy.max_attempts ||
+                             total_delay + delay > policy.max_total_delay ||
+                             (policy.budget && !policy.budget->try_withdraw());
+
+        if(give_up)
+        {
+            if constexpr(keeps_history)
+            {
+                if(!history.attempts.empty())
+                {
+                    return detail::retries_exhausted(std::move(r), std::move(history), detail::intern_site(location));
+                }
+            }
+
+            return r;
+        }
+
+        if constexpr(keeps_history)
+        {
+            history.attempts.push_back(std::move(r).release_error());
+        }
+
+        policy.sleep(delay);
+        total_delay += delay;
+        backoff = std::chrono::duration_cast<std::chrono::nanoseconds>(backoff * policy.multiplier);
+    }
+}
+
+#endif //ERRORHANDLING_RETRY_H
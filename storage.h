@@ -9,19 +9,59 @@
 #include <variant>
 #include <optional>
 #include <memory>
-#include <gsl/assert>
+#include <tuple>
+#include <utility>
 
-#if defined(__GNUC__) || defined(__clang__)
-#define finline __attribute__((always_inline))
-#elif defined(_MSC_VER)
-#define finline __forceinline
-#else
-#define finline
-#warning "no forcing of inlining is possible"
-#endif
+#include "config.h"
+#include "types.h"
+#include "memory.h"
 
 namespace detail
 {
+    // std::get without the bad_variant_access check, the caller guarantees the index
+    template<std::size_t I, class... T>
+    [[nodiscard]] finline constexpr auto& unchecked_get(std::variant<T...>& v)
+    {
+        if(std::is_constant_evaluated())
+        {
+            return std::get<I>(v);
+        }
+        return *std::get_if<I>(&v);
+    }
+
+    template<std::size_t I, class... T>
+    [[nodiscard]] finline constexpr const auto& unchecked_get(const std::variant<T...>& v)
+    {
+        if(std::is_constant_evaluated())
+        {
+            return std::get<I>(v);
+        }
+        return *std::get_if<I>(&v);
+    }
+
+    // keeps the forwarding constructors from hijacking copy construction
+    template<class T, class... Args>
+    constexpr inline bool is_self_v = sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...);
+
+    // moves the value out of an exclusively owned node, copies it if the node is shared
+    template<class T>
+    T take_failure(failure_ptr<T>&& ptr)
+    {
+        if(ptr.is_shared())
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                return *ptr;
+            }
+            else
+            {
+                return ptr->clone();
+            }
+        }
+
+        return std::move(*ptr);
+    }
+
     template<class T>
     class sbo_storage
     {
@@ -32,17 +72,56 @@ namespace detail
         {
         }
 
-        template<class...Args>
+        template<class...Args, typename = std::enable_if_t<!is_self_v<sbo_storage, Args...>>>
         sbo_storage(Args&&...args)
             : m_error(T(std::forward<Args&&>(args)...))
         {
         }
 
+        template<class...Args>
+        explicit sbo_storage(std::in_place_t, Args&&...args)
+            : m_error(std::in_place, std::forward<Args>(args)...)
+        {
+        }
+
+        explicit sbo_storage(failure_ptr<T>&& error)
+            : m_error(take_failure(std::move(error)))
+        {
+        }
+
+        sbo_storage(const sbo_storage&) = default;
+        sbo_storage& operator=(const sbo_storage&) = default;
+
+        // the source is left without error, so the drop hooks and the final action only see the failure once
+        sbo_storage(sbo_storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : m_error(std::move(other.m_error))
+        {
+            other.m_error.reset();
+        }
+
+        sbo_storage& operator=(sbo_storage&& other) noexcept(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_constructible_v<T>)
+        {
+            if(this != &other)
+            {
+                m_error = std::move(other.m_error);
+                other.m_error.reset();
+            }
+            return *this;
+        }
+
         [[nodiscard]] finline bool has_value() const { return m_error.has_value(); }
-        [[nodiscard]] finline auto get() const & -> const T& { return m_error.value(); }
-        [[nodiscard]] finline auto get() & -> T& { return m_error.value(); }
-        [[nodiscard]] finline auto get() && -> T&& { return std::move(m_error).value(); }
-        [[nodiscard]] finline T* operator ->() { return &m_error.value(); }
+        // checked by the result_storage above, std::optional::value would throw bad_optional_access
+        [[nodiscard]] finline auto get() const & -> const T& { return *m_error; }
+        [[nodiscard]] finline auto get() & -> T& { return *m_error; }
+        [[nodiscard]] finline auto get() && -> T&& { return *std::move(m_error); }
+        [[nodiscard]] finline T* operator ->() { return &*m_error; }
+        [[nodiscard]] finline failure_ptr<T> release()
+        {
+            ERR_AUDIT_EXPECTS(m_error.has_value());
+            auto released = make_failure_ptr<T>(*std::move(m_error));
+            m_error.reset();
+            return released;
+        }
 
         void reset() { m_error.reset(); }
 
@@ -50,44 +129,120 @@ namespace detail
         std::optional<T> m_error;
     };
 
+    // trivially copyable errors (error codes, enums, ...) are stored inline, never allocate
+    // and can be used in constant expressions
+    template<class T>
+    constexpr inline bool is_inline_error_v = std::is_trivially_copyable_v<T>;
+
+    template<class T>
+    class inline_storage
+    {
+    public:
+        constexpr inline_storage() = default;
+
+        constexpr explicit inline_storage(T error)
+            : m_error(std::move(error))
+        {
+        }
+
+        template<class...Args>
+        constexpr explicit inline_storage(std::in_place_t, Args&&...args)
+            : m_error(std::in_place, std::forward<Args>(args)...)
+        {
+        }
+
+        [[nodiscard]] finline constexpr bool has_value() const { return m_error.has_value(); }
+        [[nodiscard]] finline constexpr auto get() const & -> const T& { return *m_error; }
+        [[nodiscard]] finline constexpr auto get() & -> T& { return *m_error; }
+        [[nodiscard]] finline constexpr auto get() && -> T&& { return std::move(*m_error); }
+        [[nodiscard]] finline constexpr T* operator ->() { return &*m_error; }
+
+        // the storage is empty afterwards, like a released pointer_storage
+        [[nodiscard]] finline constexpr T release()
+        {
+            T released = std::move(*m_error);
+            m_error.reset();
+            return released;
+        }
+
+        constexpr void reset() { m_error.reset(); }
+
+    private:
+        std::optional<T> m_error;
+    };
+
     template<class T>
     class pointer_storage
     {
     public:
         pointer_storage() = default;
         explicit pointer_storage(T&& error)
-            : m_data(new T(std::move(error)))
+            : m_data(make_failure_ptr<T>(std::move(error)))
         {
         }
 
-        template<class...Args>
+        template<class...Args, typename = std::enable_if_t<!is_self_v<pointer_storage, Args...>>>
         pointer_storage(Args&&...args)
-            : m_data(new T(std::forward<Args&&>(args)...))
+            : m_data(make_failure_ptr<T>(std::forward<Args&&>(args)...))
+        {
+        }
+
+        template<class...Args>
+        explicit pointer_storage(std::in_place_t, Args&&...args)
+            : m_data(make_failure_ptr<T>(std::forward<Args>(args)...))
         {
         }
 
-        pointer_storage(std::unique_ptr<T>&& error)
+        pointer_storage(failure_ptr<T>&& error)
             : m_data(std::move(error))
         {
         }
 
+        // copies share the error node
+        pointer_storage(const pointer_storage& other)
+            : m_data(other.m_data.share())
+        {
+        }
+
+        pointer_storage(pointer_storage&&) noexcept = default;
+        pointer_storage& operator=(pointer_storage&&) noexcept = default;
+
         [[nodiscard]] finline bool has_value() const { return m_data != nullptr; }
         [[nodiscard]] finline auto get() const & -> const T& { return *m_data; }
         [[nodiscard]] finline auto get() & -> T& { return *m_data; }
-        [[nodiscard]] finline auto get() && -> T&& { return std::move(*m_data); }
+        // a shared node is copied first, the other owners keep theirs
+        [[nodiscard]] finline auto get() && -> T&&
+        {
+            if(m_data.is_shared())
+            {
+                m_data = make_failure_ptr<T>(take_failure(std::move(m_data)));
+            }
+            return std::move(*m_data);
+        }
         [[nodiscard]] finline T* operator ->() { return m_data.get(); }
-        [[nodiscard]] finline T* release() { return m_data.release(); }
+        [[nodiscard]] finline failure_ptr<T> release() { return std::move(m_data); }
 
         void reset() { m_data.reset(); }
 
     private:
-        std::unique_ptr<T> m_data;
+        failure_ptr<T> m_data;
     };
 
+    // storage of the error of result<void, Error> and result<T&, Error>
+    template<class Error>
+    using error_storage_t = std::conditional_t<is_inline_error_v<Error>, inline_storage<Error>, pointer_storage<Error>>;
+
+    // failure_ptr<Error> for heap allocated errors, Error itself for inline errors
+    template<class Error>
+    using released_error_t = decltype(std::declval<error_storage_t<Error>&>().release());
+
     template<class Value, class Error>
-    using result_storage_t = std::conditional_t<sizeof(Error) <= sizeof(Value),
-            std::variant<Value, sbo_storage<Error>>,
-            std::variant<Value, pointer_storage<Error>>>;
+    using result_storage_t = std::variant<Value,
+            std::conditional_t<is_inline_error_v<Error>,
+                               inline_storage<Error>,
+                               std::conditional_t<sizeof(Error) <= sizeof(Value),
+                                                  sbo_storage<Error>,
+                                                  pointer_storage<Error>>>>;
 
     template<class Value, class Error>
     class result_storage
@@ -95,32 +250,124 @@ namespace detail
     public:
         using error_storage_type = std::decay_t<decltype(std::get<1>(std::declval<result_storage_t<Value, Error>>()))>;
 
-        explicit result_storage(Value&& value)
+        constexpr explicit result_storage(Value&& value)
             : m_storage(std::move(value))
         {
         }
 
-        explicit result_storage(Error&& error)
+        constexpr explicit result_storage(Error&& error)
             : m_storage(error_storage_type(std::move(error)))
         {
         }
 
-        explicit result_storage(error_storage_type&& error)
+        constexpr explicit result_storage(error_storage_type&& error)
                 : m_storage(error_storage_type(std::move(error)))
         {
         }
 
-        [[nodiscard]] finline bool has_value() const { return std::holds_alternative<Value>(m_storage); }
-        [[nodiscard]] finline bool has_error() const { return !std::holds_alternative<Value>(m_storage); }
+        explicit result_storage(failure_ptr<Error>&& error)
+            : m_storage(std::in_place_index<1>, std::move(error))
+        {
+        }
 
-        [[nodiscard]] finline auto get_value() const & -> const Value& { Expects(has_value()); return std::get<0>(m_storage); }
-        [[nodiscard]] finline auto get_error() const & -> const Error& { Expects(has_error()); return std::get<1>(m_storage).get(); }
+        // constructs the value directly inside the variant, no intermediate moves
+        template<class...Args>
+        constexpr result_storage(in_place_success<Value, Args...>&& s) // NOLINT(google-explicit-constructor)
+            : result_storage(std::move(s), std::index_sequence_for<Args...>{})
+        {
+        }
 
-        [[nodiscard]] finline auto get_value() && -> Value&& { Expects(has_value()); return std::get<0>(std::move(m_storage)); }
-        [[nodiscard]] finline auto get_error() && -> Error&& { Expects(has_error()); return std::get<1>(std::move(m_storage)).get(); }
+        // constructs the error directly inside its storage, no intermediate moves
+        template<class E, class...Args, typename = std::enable_if_t<std::is_same_v<E, Error>>>
+        constexpr result_storage(in_place_failure<E, Args...>&& f) // NOLINT(google-explicit-constructor)
+            : result_storage(std::move(f), std::index_sequence_for<Args...>{})
+        {
+        }
+
+        [[nodiscard]] finline constexpr bool has_value() const { return std::holds_alternative<Value>(m_storage); }
+        // false for both, value and error, once the error has been released
+        [[nodiscard]] finline constexpr bool has_error() const { return m_storage.index() == 1 && unchecked_get<1>(m_storage).has_value(); }
+
+        // checked by result already
+        [[nodiscard]] finline constexpr auto get_value() const & -> const Value& { ERR_AUDIT_EXPECTS(has_value()); return unchecked_get<0>(m_storage); }
+        [[nodiscard]] finline constexpr auto get_error() const & -> const Error& { ERR_AUDIT_EXPECTS(has_error()); return unchecked_get<1>(m_storage).get(); }
+
+        [[nodiscard]] finline constexpr auto get_value() && -> Value&& { ERR_AUDIT_EXPECTS(has_value()); return std::move(unchecked_get<0>(m_storage)); }
+        [[nodiscard]] finline constexpr auto get_error() && -> Error&& { ERR_AUDIT_EXPECTS(has_error()); return std::move(unchecked_get<1>(m_storage)).get(); }
+
+        // transfers the error node if the error is heap allocated already
+        [[nodiscard]] constexpr auto release_error() && -> released_error_t<Error> { ERR_EXPECTS(has_error()); return unchecked_get<1>(m_storage).release(); }
     private:
+        template<class...Args, std::size_t...I>
+        constexpr result_storage(in_place_success<Value, Args...>&& s, std::index_sequence<I...>)
+            : m_storage(std::in_place_index<0>, std::get<I>(std::move(s.args))...)
+        {
+        }
+
+        template<class...Args, std::size_t...I>
+        constexpr result_storage(in_place_failure<Error, Args...>&& f, std::index_sequence<I...>)
+            : m_storage(std::in_place_index<1>, std::in_place, std::get<I>(std::move(f.args))...)
+        {
+        }
+
         result_storage_t<Value, Error> m_storage;
     };
+
+    // references are stored as pointer next to the error storage, the two are not overlaid:
+    // result<T&> is as large as the pointer plus error_storage_t<Error> (16 bytes for error).
+    // the pointer doubles as discriminator, it is null exactly if the error storage is engaged
+    template<class Value, class Error>
+    class result_storage<Value&, Error>
+    {
+    public:
+        using error_storage_type = error_storage_t<Error>;
+
+        constexpr explicit result_storage(Value& value)
+            : m_value(std::addressof(value))
+        {
+        }
+
+        constexpr explicit result_storage(Error&& error)
+            : m_error(std::move(error))
+        {
+        }
+
+        constexpr explicit result_storage(error_storage_type&& error)
+            : m_error(std::move(error))
+        {
+        }
+
+        explicit result_storage(failure_ptr<Error>&& error)
+            : m_error(std::move(error))
+        {
+        }
+
+        template<class E, class...Args, typename = std::enable_if_t<std::is_same_v<E, Error>>>
+        constexpr result_storage(in_place_failure<E, Args...>&& f) // NOLINT(google-explicit-constructor)
+            : result_storage(std::move(f), std::index_sequence_for<Args...>{})
+        {
+        }
+
+        [[nodiscard]] finline constexpr bool has_value() const { return m_value != nullptr; }
+        [[nodiscard]] finline constexpr bool has_error() const { return m_value == nullptr && m_error.has_value(); }
+
+        [[nodiscard]] finline constexpr auto get_value() const & -> Value& { ERR_AUDIT_EXPECTS(has_value()); return *m_value; }
+        [[nodiscard]] finline constexpr auto get_error() const & -> const Error& { ERR_AUDIT_EXPECTS(has_error()); return m_error.get(); }
+
+        [[nodiscard]] finline constexpr auto get_value() && -> Value& { ERR_AUDIT_EXPECTS(has_value()); return *m_value; }
+        [[nodiscard]] finline constexpr auto get_error() && -> Error&& { ERR_AUDIT_EXPECTS(has_error()); return std::move(m_error).get(); }
+
+        [[nodiscard]] constexpr auto release_error() && -> released_error_t<Error> { ERR_EXPECTS(has_error()); return m_error.release(); }
+    private:
+        template<class...Args, std::size_t...I>
+        constexpr result_storage(in_place_failure<Error, Args...>&& f, std::index_sequence<I...>)
+            : m_error(std::in_place, std::get<I>(std::move(f.args))...)
+        {
+        }
+
+        Value* m_value = nullptr;
+        error_storage_type m_error;
+    };
 }
 
 #endif //ERRORHANDLING_STORAGE_H
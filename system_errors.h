@@ -0,0 +1,230 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_SYSTEM_ERRORS_H
+#define ERRORHANDLING_SYSTEM_ERRORS_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <string_view>
+
+// the errno codes and sys::check are portable, the syscall wrappers need a POSIX system
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <unistd.h>
+#define ERR_POSIX_SYSCALLS 1
+#else
+#define ERR_POSIX_SYSCALLS 0
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#include "result.h"
+#include "try.h"
+
+// errno values as error codes. the codes are not defined one by one, code(errno) looks them up
+// in a constexpr table indexed by the errno value, the local id of a code is its errno value.
+namespace system_errors
+{
+    // outside of the range used by applications
+    DEFINE_ERROR_CATEGORY(0x10000, system_category);
+
+    struct errno_entry
+    {
+        int value;
+        std::string_view name;
+        std::string_view description;
+        retry_trait retry;
+    };
+
+    inline constexpr errno_entry known_errnos[] =
+    {
+        { EPERM,        "EPERM",        "Operation not permitted",                  retry_trait::permanent },
+        { ENOENT,       "ENOENT",       "No such file or directory",                retry_trait::permanent },
+        { EINTR,        "EINTR",        "Interrupted system call",                  retry_trait::transient },
+        { EIO,          "EIO",          "Input/output error",                       retry_trait::permanent },
+        { EBADF,        "EBADF",        "Bad file descriptor",                      retry_trait::permanent },
+        { EAGAIN,       "EAGAIN",       "Resource temporarily unavailable",         retry_trait::transient },
+        { EWOULDBLOCK,  "EWOULDBLOCK",  "Operation would block",                    retry_trait::transient },
+        { ENOMEM,       "ENOMEM",       "Cannot allocate memory",                   retry_trait::transient },
+        { EACCES,       "EACCES",       "Permission denied",                        retry_trait::permanent },
+        { EFAULT,       "EFAULT",       "Bad address",                              retry_trait::permanent },
+        { EBUSY,        "EBUSY",        "Device or resource busy",                  retry_trait::transient },
+        { EEXIST,       "EEXIST",       "File exists",                              retry_trait::permanent },
+        { ENOTDIR,      "ENOTDIR",      "Not a directory",                          retry_trait::permanent },
+        { EISDIR,       "EISDIR",       "Is a directory",                           retry_trait::permanent },
+        { EINVAL,       "EINVAL",       "Invalid argument",                         retry_trait::permanent },
+        { ENFILE,       "ENFILE",       "Too many open files in system",            retry_trait::transient },
+        { EMFILE,       "EMFILE",       "Too many open files",                      retry_trait::transient },
+        { ENOSPC,       "ENOSPC",       "No space left on device",                  retry_trait::permanent },
+        { ESPIPE,       "ESPIPE",       "Illegal seek",                             retry_trait::permanent },
+        { EROFS,        "EROFS",        "Read-only file system",                    retry_trait::permanent },
+        { EPIPE,        "EPIPE",        "Broken pipe",                              retry_trait::permanent },
+        { ENAMETOOLONG, "ENAMETOOLONG", "File name too long",                       retry_trait::permanent },
+        { ENOSYS,       "ENOSYS",       "Function not implemented",                 retry_trait::permanent },
+        { ENOTEMPTY,    "ENOTEMPTY",    "Directory not empty",                      retry_trait::permanent },
+        { ENOTSOCK,     "ENOTSOCK",     "Socket operation on non-socket",           retry_trait::permanent },
+        { EMSGSIZE,     "EMSGSIZE",     "Message too long",                         retry_trait::permanent },
+        { EOPNOTSUPP,   "EOPNOTSUPP",   "Operation not supported",                  retry_trait::permanent },
+        { EADDRINUSE,   "EADDRINUSE",   "Address already in use",                   retry_trait::transient },
+        { EADDRNOTAVAIL,"EADDRNOTAVAIL","Cannot assign requested address",          retry_trait::permanent },
+        { ENETDOWN,     "ENETDOWN",     "Network is down",                          retry_trait::transient },
+        { ENETUNREACH,  "ENETUNREACH",  "Network is unreachable",                   retry_trait::transient },
+        { ECONNABORTED, "ECONNABORTED", "Software caused connection abort",         retry_trait::transient },
+        { ECONNRESET,   "ECONNRESET",   "Connection reset by peer",                 retry_trait::transient },
+        { ENOBUFS,      "ENOBUFS",      "No buffer space available",                retry_trait::throttled },
+        { EISCONN,      "EISCONN",      "Transport endpoint is already connected",  retry_trait::permanent },
+        { ENOTCONN,     "ENOTCONN",     "Transport endpoint is not connected",      retry_trait::permanent },
+        { ETIMEDOUT,    "ETIMEDOUT",    "Connection timed out",                     retry_trait::transient },
+        { ECONNREFUSED, "ECONNREFUSED", "Connection refused",                       retry_trait::transient },
+        { EHOSTUNREACH, "EHOSTUNREACH", "No route to host",                         retry_trait::transient },
+        { EALREADY,     "EALREADY",     "Operation already in progress",            retry_trait::permanent },
+        { EINPROGRESS,  "EINPROGRESS",  "Operation now in progress",                retry_trait::transient },
+        { ECANCELED,    "ECANCELED",    "Operation canceled",                       retry_trait::permanent },
+    };
+
+    // dense, indexed by the errno value. on platforms where EWOULDBLOCK == EAGAIN the first entry wins
+    inline constexpr auto errno_table = []()
+    {
+        constexpr auto size = std::max_element(std::begin(known_errnos), std::end(known_errnos),
+                                               [](const auto& a, const auto& b) { return a.value < b.value; })->value + 1;
+
+        std::array<errno_entry, static_cast<std::size_t>(size)> table {};
+        for(const auto& entry : known_errnos)
+        {
+            if(table[entry.value].name.empty())
+            {
+                table[entry.value] = entry;
+            }
+        }
+        return table;
+    }();
+
+    [[nodiscard]] constexpr error_code code(int value)
+    {
+        const auto id = static_cast<uint64_t>(static_cast<uint32_t>(value)) + (uint64_t { system_category::id } << 32);
+        if(value > 0 && static_cast<std::size_t>(value) < errno_table.size() && !errno_table[value].name.empty())
+        {
+            const auto& entry = errno_table[value];
+            return error_code(system_category{}, id, entry.name, entry.description, entry.retry);
+        }
+
+        return error_code(system_category{}, id, "unknown_errno", "Unknown system error", retry_trait::permanent);
+    }
+
+    // the error of the syscall helpers, an errno value stored inline that never allocates.
+    // escalated to an error with code(value) once it is propagated into a result<V, error>
+    struct errno_code
+    {
+        int value;
+
+        [[nodiscard]] constexpr bool would_block() const { return value == EAGAIN || value == EWOULDBLOCK; }
+        [[nodiscard]] constexpr bool interrupted() const { return value == EINTR; }
+        [[nodiscard]] constexpr bool operator==(const errno_code&) const = default;
+    };
+
+    [[nodiscard]] constexpr error_code to_error_code(errno_code e)
+    {
+        return code(e.value);
+    }
+}
+
+// thin wrappers of the syscalls, the return value or -1 and errno become a result
+namespace sys
+{
+    template<class V>
+    using result = ::result<V, system_errors::errno_code>;
+
+    template<class T>
+    [[nodiscard]] result<T> check(T rv)
+    {
+        if(ERR_UNLIKELY(rv == -1))
+        {
+            return err(system_errors::errno_code { errno });
+        }
+
+        return ok(rv);
+    }
+
+    [[nodiscard]] inline result<void> check_void(int rv)
+    {
+        if(ERR_UNLIKELY(rv == -1))
+        {
+            return err(system_errors::errno_code { errno });
+        }
+
+        return ok();
+    }
+
+    // repeats the call while it fails with EINTR
+    template<class F>
+    [[nodiscard]] auto restart_on_eintr(F&& f) -> std::invoke_result_t<F&>
+    {
+        for(;;)
+        {
+            auto r = std::invoke(f);
+            if(ERR_LIKELY(r.is_ok()) || !r.unchecked_error().interrupted())
+            {
+                return r;
+            }
+        }
+    }
+
+#if ERR_POSIX_SYSCALLS
+    [[nodiscard]] inline result<std::size_t> read(int fd, void* buffer, std::size_t size)
+    {
+        TRY_ASSIGN(const auto count, check(::read(fd, buffer, size)));
+        return ok(static_cast<std::size_t>(count));
+    }
+
+    [[nodiscard]] inline result<std::size_t> write(int fd, const void* buffer, std::size_t size)
+    {
+        TRY_ASSIGN(const auto count, check(::write(fd, buffer, size)));
+        return ok(static_cast<std::size_t>(count));
+    }
+
+    [[nodiscard]] inline result<void> close(int fd)
+    {
+        return check_void(::close(fd));
+    }
+
+    [[nodiscard]] inline result<void> set_nonblocking(int fd)
+    {
+        TRY_ASSIGN(const auto flags, check(::fcntl(fd, F_GETFL)));
+        return check_void(::fcntl(fd, F_SETFL, flags | O_NONBLOCK));
+    }
+
+    // read end first
+    [[nodiscard]] inline result<std::array<int, 2>> pipe()
+    {
+        std::array<int, 2> fds {};
+        TRY(check_void(::pipe(fds.data())));
+        return ok(fds);
+    }
+#endif // ERR_POSIX_SYSCALLS
+
+#if defined(__linux__)
+    [[nodiscard]] inline result<int> epoll_create()
+    {
+        return check(::epoll_create1(EPOLL_CLOEXEC));
+    }
+
+    [[nodiscard]] inline result<void> epoll_ctl(int epfd, int op, int fd, epoll_event* event)
+    {
+        return check_void(::epoll_ctl(epfd, op, fd, event));
+    }
+
+    // number of ready events
+    [[nodiscard]] inline result<int> epoll_wait(int epfd, epoll_event* events, int max_events, int timeout_ms)
+    {
+        return check(::epoll_wait(epfd, events, max_events, timeout_ms));
+    }
+#endif
+}
+
+#endif //ERRORHANDLING_SYSTEM_ERRORS_H
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Created by flori on 19.10.2026.
+#
+# Maps errors of builds with ERR_VERBOSITY below ERR_VERBOSITY_FULL back to their sources. Such builds print
+# sites as site#<id>:<line>, where id is the FNV-1a hash of "file:line" (see detail::site_id in error.h).
+#
+#   error_sites.py extract [--prefix P] <files or directories>... > sites.tsv
+#       writes the id, file, line and macro invocation of every TRY, TRY_ASSIGN, TRYX, RETURN, EXPECT, ENSURE,
+#       err and static_err in the sources. the paths must be spelled like __FILE__ in the build: run it from
+#       the build's working directory with the paths passed to the compiler, or build with
+#       -ffile-prefix-map=<source dir>/= and run it from the source directory. --prefix is put in front of every path.
+#   error_sites.py resolve sites.tsv < log > resolved_log
+#       replaces site#<id>:<line> with file:line and the invocation, e.g.
+#       at site#6c62272e07bb0142:42  ->  at parser.cpp:42 [err(parse_error{}, "unexpected token")]
+#
+# sites in macros of the project itself are not found, sites on the same line share their id.
+
+import argparse
+import os
+import re
+import sys
+
+MACRO = re.compile(r'\b(TRY|TRY_ASSIGN|TRYX|RETURN|EXPECT|ENSURE|err|static_err)\s*\(')
+STRIPPED_SITE = re.compile(r'site#([0-9a-f]{16}):(\d+)')
+SOURCE_SUFFIXES = ('.h', '.hh', '.hpp', '.hxx', '.c', '.cc', '.cpp', '.cxx', '.cppm', '.ixx')
+
+
+def site_id(file, line):
+    hash = 0xcbf29ce484222325
+    for byte in f'{file}:{line}'.encode():
+        hash ^= byte
+        hash = (hash * 0x100000001b3) & 0xffffffffffffffff
+    return hash
+
+
+def invocation_end(text, start):
+    """index after the parenthesis closing the one before start, skipping string and character literals"""
+    depth = 1
+    i = start
+    while i < len(text) and depth:
+        c = text[i]
+        if c in '"\'':
+            i += 1
+            while i < len(text) and text[i] != c:
+                i += 2 if text[i] == '\\' else 1
+        elif c == '(':
+            depth += 1
+        elif c == ')':
+            depth -= 1
+        i += 1
+    return i
+
+
+def extract_file(path, name):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        text = f.read()
+
+    line_starts = [0] + [i + 1 for i, c in enumerate(text) if c == '\n']
+    for match in MACRO.finditer(text):
+        line_index = text.count('\n', 0, match.start())
+        line = text[line_starts[line_index]:match.start()]
+        if '//' in line or line.lstrip().startswith(('#define', '*', '/*')):
+            continue
+
+        end = invocation_end(text, match.end())
+        invocation = ' '.join(text[match.start():end].split())
+        yield site_id(name, line_index + 1), name, line_index + 1, invocation
+
+
+def sources(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for root, dirs, files in os.walk(path):
+                dirs.sort()
+                for file in sorted(files):
+                    if file.endswith(SOURCE_SUFFIXES):
+                        yield os.path.join(root, file)
+        else:
+            yield path
+
+
+def extract(args):
+    for path in sources(args.paths):
+        for id, file, line, invocation in extract_file(path, args.prefix + path):
+            print(f'{id:016x}\t{file}\t{line}\t{invocation}')
+
+
+def resolve(args):
+    sites = {}
+    with open(args.symbols, encoding='utf-8') as f:
+        for entry in f:
+            id, file, line, invocation = entry.rstrip('\n').split('\t', 3)
+            if id in sites:
+                sites[id] = (file, line, sites[id][2] + ' | ' + invocation)
+            else:
+                sites[id] = (file, line, invocation)
+
+    def replace(match):
+        site = sites.get(match.group(1))
+        if site is None:
+            return match.group(0)
+        return f'{site[0]}:{site[1]} [{site[2]}]'
+
+    for line in sys.stdin:
+        sys.stdout.write(STRIPPED_SITE.sub(replace, line))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='maps stripped error sites back to the sources')
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    extract_parser = commands.add_parser('extract', help='write the symbol file of the sources')
+    extract_parser.add_argument('--prefix', default='', help='put in front of every path, e.g. the source directory')
+    extract_parser.add_argument('paths', nargs='+')
+    extract_parser.set_defaults(run=extract)
+
+    resolve_parser = commands.add_parser('resolve', help='resolve the sites of a log read from stdin')
+    resolve_parser.add_argument('symbols')
+    resolve_parser.set_defaults(run=resolve)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,269 @@
+//
+// Created by flori on 18.10.2026.
+//
+
+#ifndef ERRORHANDLING_TRACE_H
+#define ERRORHANDLING_TRACE_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "config.h"
+
+// opt-in timeline of error lifecycles, define ERR_TRACING before including the library to compile it in.
+// recording is disabled at runtime until error_tracing::enable() is called,
+// a disabled trace point costs one relaxed load and a predictable branch.
+enum class trace_event_kind : uint8_t
+{
+    create,     // error constructed
+    propagate,  // passed through a TRY frame
+    handle,     // passed to handle_error
+    drop        // result destroyed with an error, i.e. seen by the final action
+};
+
+#ifdef ERR_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace error_tracing
+{
+    struct event
+    {
+        int64_t timestamp; // steady clock, nanoseconds
+        uint64_t code;
+        std::string_view name; // name of the error code, points to a literal
+        const char* file;
+        int32_t line;
+        uint32_t thread;
+        trace_event_kind kind;
+    };
+
+    namespace detail
+    {
+        inline std::atomic<bool> enabled { false };
+
+        // single producer (the owning thread), single consumer (the flushing thread).
+        // events are dropped instead of overwritten while the buffer is full.
+        class ring_buffer
+        {
+        public:
+            static constexpr std::size_t capacity = 1u << 14;
+
+            explicit ring_buffer(uint32_t thread)
+                : m_thread(thread)
+                , m_events(std::make_unique<event[]>(capacity))
+            {
+            }
+
+            void push(event e)
+            {
+                const auto head = m_head.load(std::memory_order_relaxed);
+                if(head - m_tail.load(std::memory_order_acquire) == capacity)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                e.thread = m_thread;
+                m_events[head % capacity] = e;
+                m_head.store(head + 1, std::memory_order_release);
+            }
+
+            template<class F>
+            void drain(F&& consume)
+            {
+                const auto head = m_head.load(std::memory_order_acquire);
+                auto tail = m_tail.load(std::memory_order_relaxed);
+                for(; tail != head; ++tail)
+                {
+                    consume(m_events[tail % capacity]);
+                }
+                m_tail.store(tail, std::memory_order_release);
+            }
+
+            [[nodiscard]] uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+            // called by the owning thread when it exits, it pushes nothing afterwards
+            void retire() { m_retired.store(true, std::memory_order_release); }
+            [[nodiscard]] bool is_retired() const { return m_retired.load(std::memory_order_acquire); }
+
+        private:
+            const uint32_t m_thread;
+            std::unique_ptr<event[]> m_events;
+            alignas(64) std::atomic<uint64_t> m_head { 0 };
+            alignas(64) std::atomic<uint64_t> m_tail { 0 };
+            std::atomic<uint64_t> m_dropped { 0 };
+            std::atomic<bool> m_retired { false };
+        };
+
+        // buffers outlive their thread until they were drained, so nothing is lost on flush
+        struct registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ring_buffer>> buffers;
+            uint32_t next_thread = 1;
+            uint64_t retired_dropped = 0; // of the buffers already released
+        };
+
+        inline registry& get_registry()
+        {
+            static registry instance;
+            return instance;
+        }
+
+        // retires the buffer of the thread when it exits
+        struct buffer_owner
+        {
+            buffer_owner()
+            {
+                auto& r = get_registry();
+                std::scoped_lock lock(r.mutex);
+                buffer = r.buffers.emplace_back(std::make_shared<ring_buffer>(r.next_thread++));
+            }
+
+            ~buffer_owner() { buffer->retire(); }
+
+            std::shared_ptr<ring_buffer> buffer;
+        };
+
+        inline ring_buffer& local_buffer()
+        {
+            thread_local const buffer_owner owner;
+            return *owner.buffer;
+        }
+
+        ERR_COLD inline void record(trace_event_kind kind, uint64_t code, std::string_view name, const char* file, int line)
+        {
+            const auto now = std::chrono::steady_clock::now().time_since_epoch();
+            local_buffer().push(
+            {
+                .timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+                .code = code,
+                .name = name,
+                .file = file,
+                .line = line,
+                .thread = 0,
+                .kind = kind
+            });
+        }
+
+        inline std::string_view kind_name(trace_event_kind kind)
+        {
+            switch(kind)
+            {
+                case trace_event_kind::create:      return "create";
+                case trace_event_kind::propagate:   return "propagate";
+                case trace_event_kind::handle:      return "handle";
+                case trace_event_kind::drop:        return "drop";
+            }
+            return "unknown";
+        }
+
+        inline void write_json_string(std::ostream& os, std::string_view s)
+        {
+            for(const auto c : s)
+            {
+                if(c == '"' || c == '\\')
+                {
+                    os << '\\';
+                }
+                os << c;
+            }
+        }
+    }
+
+    inline void enable() { detail::enabled.store(true, std::memory_order_relaxed); }
+    inline void disable() { detail::enabled.store(false, std::memory_order_relaxed); }
+    [[nodiscard]] inline bool is_enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    // events lost because a thread's buffer was full
+    [[nodiscard]] inline uint64_t dropped_events()
+    {
+        auto& r = detail::get_registry();
+        std::scoped_lock lock(r.mutex);
+
+        uint64_t dropped = r.retired_dropped;
+        for(const auto& buffer : r.buffers)
+        {
+            dropped += buffer->dropped();
+        }
+        return dropped;
+    }
+
+    // drains all buffers, the consumer is invoked per event in per-thread order.
+    // the buffers of exited threads are released once they are drained
+    template<class F>
+    void drain(F&& consume)
+    {
+        auto& r = detail::get_registry();
+        std::scoped_lock lock(r.mutex);
+
+        for(auto it = r.buffers.begin(); it != r.buffers.end();)
+        {
+            const auto retired = (*it)->is_retired();
+            (*it)->drain(consume);
+
+            if(retired)
+            {
+                r.retired_dropped += (*it)->dropped();
+                it = r.buffers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // drains all buffers as Chrome trace event JSON (instant events), loadable by ui.perfetto.dev and chrome://tracing
+    inline void write_chrome_trace(std::ostream& os)
+    {
+        os << "{\"traceEvents\":[";
+
+        bool first = true;
+        drain([&](const event& e)
+        {
+            os << (first ? "\n" : ",\n");
+            first = false;
+
+            os << "{\"name\":\"";
+            detail::write_json_string(os, e.name);
+            os << fmt::format(R"(","cat":"{}","ph":"i","s":"t","ts":{:.3f},"pid":1,"tid":{},"args":{{"code":{},"origin":")",
+                              detail::kind_name(e.kind),
+                              static_cast<double>(e.timestamp) / 1000.0,
+                              e.thread,
+                              e.code);
+            detail::write_json_string(os, e.file ? e.file : "");
+            os << ':' << e.line << "\"}}";
+        });
+
+        os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+}
+
+// cond is only evaluated while tracing is enabled
+#define ERR_TRACE_IF(cond, kind, code, origin) \
+    do \
+    { \
+        if(ERR_UNLIKELY(error_tracing::is_enabled()) && (cond)) \
+        { \
+            error_tracing::detail::record(kind, (code).get_id(), (code).get_name(), (origin).file, (origin).line); \
+        } \
+    } while(false)
+
+#else
+
+#define ERR_TRACE_IF(cond, kind, code, origin) do {} while(false)
+
+#endif // ERR_TRACING
+
+#define ERR_TRACE(kind, code, origin) ERR_TRACE_IF(true, kind, code, origin)
+
+#endif //ERRORHANDLING_TRACE_H
@@ -0,0 +1,143 @@
+//
+// Created by flori on 19.10.2026.
+//
+
+#ifndef ERRORHANDLING_TRY_H
+#define ERRORHANDLING_TRY_H
+
+#include <functional>
+#include <type_traits>
+
+#include "result.h"
+#include "context.h"
+#include "result_macros.h"
+
+namespace detail
+{
+    template<class E>
+    ERR_COLD error escalate(const E& e, const error_site& site)
+    {
+        static_assert(has_error_code<E>, "escalating a small error into an error requires a to_error_code overload");
+        return error(code_of(e), site);
+    }
+
+    // the error of a failed result as the cause of a new error
+    template<class V, class E, class L>
+    auto release_cause(result<V, E, L>&& result, const error_site& site)
+    {
+        if constexpr(is_inline_error_v<E>)
+        {
+            return make_failure_ptr<error>(escalate(std::move(result).release_error(), site));
+        }
+        else
+        {
+            return std::move(result).release_error();
+        }
+    }
+
+    // an inline error leaving a TRY frame. it stays inline as long as the enclosing function returns
+    // a result with a small error type too, and is escalated to a full error at the first function
+    // returning result<V, error>: the error_code of the small error becomes the root cause
+    // at the site of that TRY.
+    template<class E, class Site>
+    struct [[nodiscard]] inline_propagation
+    {
+        E value;
+        Site site;
+
+        template<class V, class E2, class L>
+        constexpr operator result<V, E2, L>() && // NOLINT(google-explicit-constructor)
+        {
+            if constexpr(std::is_same_v<E2, error>)
+            {
+                auto escalated = escalate(value, site());
+                error_context::detail::capture(escalated);
+                return failure<error> { std::move(escalated) };
+            }
+            else
+            {
+                static_assert(std::is_constructible_v<E2, E&&>, "the error can not be propagated into this result");
+                return failure<E> { std::move(value) };
+            }
+        }
+    };
+
+    // site is a LAZY_FAILURE_SITE, it is only invoked if an error is recorded.
+    // inline errors are passed on unchanged, which keeps TRY usable in constant expressions
+    template<class Site, class V, class E, class L>
+    ERR_COLD constexpr auto propagate_failure(Site site, result<V, E, L>&& result)
+    {
+        if constexpr(is_inline_error_v<E>)
+        {
+            return inline_propagation<E, Site> { std::move(result).release_error(), site };
+        }
+        else
+        {
+            auto propagated = detail::make_failure(basic_errors::propagated_error{},
+                                                   {},
+                                                   std::move(result).release_error(),
+                                                   site());
+            error_context::detail::capture(propagated.error);
+            return propagated;
+        }
+    }
+
+    template<class ErrorCode, class V, class E, class L>
+    auto resolve_failed_result(ErrorCode &&code,
+                               std::string_view explanation,
+                               result<V, E, L> &&result,
+                               const error_site& site)
+    {
+        return detail::make_failure(std::forward<ErrorCode>(code),
+                                    explanation,
+                                    release_cause(std::move(result), site),
+                                    site);
+    }
+
+    template<class ErrorCode, class T>
+    auto resolve_failed_result(ErrorCode &&code,
+                               std::string_view explanation,
+                               T &&data,
+                               const error_site& site)
+    {
+        return detail::make_failure(std::forward<ErrorCode>(code),
+                                    explanation,
+                                    std::forward<T>(data),
+                                    site);
+    }
+
+    template<class ErrorCode, class V, class E, class L, class T>
+    auto resolve_failed_result(ErrorCode &&code,
+                               std::string_view explanation,
+                               result <V, E, L> &result,
+                               T &&data,
+                               const error_site& site)
+    {
+        return detail::make_failure(std::forward<ErrorCode>(code),
+                                    explanation,
+                                    release_cause(std::move(result), site),
+                                    std::forward<T>(data),
+                                    site);
+    }
+
+}
+
+namespace detail
+{
+    // the value of a TRYX expression, references are yielded as std::reference_wrapper
+    // because statement expressions always produce a prvalue
+    template<class V, class E, class L>
+    constexpr auto tryx_value(result<V, E, L>&& result)
+        -> std::conditional_t<std::is_reference_v<V>, std::reference_wrapper<std::remove_reference_t<V>>, V>
+    {
+        return std::move(result).unchecked_value();
+    }
+}
+
+template<class T>
+struct is_result_t : std::bool_constant<false> {};
+
+template<class V, class E, class L>
+struct is_result_t<result<V, E, L>> : std::bool_constant<true> {};
+
+#endif //ERRORHANDLING_TRY_H
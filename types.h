@@ -14,9 +14,20 @@ namespace detail
             std::is_class_v<T> &&
             std::is_default_constructible_v<T>;
 
-    using default_final_action = decltype([](const auto&) noexcept {});
+    // a named type rather than a lambda, whose type would differ between translation units
+    struct default_final_action
+    {
+        template<class R>
+        constexpr void operator()(const R&) const noexcept {}
+    };
 
     static_assert(is_final_action_v<default_final_action, int>);
+
+    template<class T, class... Args>
+    struct in_place_success;
+
+    template<class T, class... Args>
+    struct in_place_failure;
 }
 
 class error;